@@ -0,0 +1,149 @@
+//
+// Measures the throughput of the batched AABB intersection kernel against a plain per-box
+// loop for increasing box counts. Boxes are scattered randomly over the world with sizes
+// similar to those of props; the query box is the size of mario's prop interaction box.
+//
+// usage: aabb_kernel_bench [iterations]
+//
+
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include "AABBKernel.h"
+#include "Defines.h"
+
+struct BoxSet
+{
+  std::vector<float> _xmin;
+  std::vector<float> _xmax;
+  std::vector<float> _ymin;
+  std::vector<float> _ymax;
+
+  AABBArrays getArrays() const
+  {
+    return AABBArrays{_xmin.data(), _xmax.data(), _ymin.data(), _ymax.data()};
+  }
+};
+
+static BoxSet makeBoxes(int count, std::mt19937& rng)
+{
+  std::uniform_real_distribution<float> x {0.f, static_cast<float>(worldSize._x)};
+  std::uniform_real_distribution<float> y {0.f, static_cast<float>(worldSize._y)};
+  std::uniform_real_distribution<float> w {8.f, 64.f};
+  std::uniform_real_distribution<float> h {2.f, 32.f};
+
+  BoxSet boxes {};
+  for(int i = 0; i < count; ++i){
+    float xmin = x(rng), ymin = y(rng);
+    boxes._xmin.push_back(xmin);
+    boxes._xmax.push_back(xmin + w(rng));
+    boxes._ymin.push_back(ymin);
+    boxes._ymax.push_back(ymin + h(rng));
+  }
+  return boxes;
+}
+
+static int referenceIntersections(const pxr::AABB& query, const BoxSet& boxes, int* hits)
+{
+  int hitCount {0};
+  for(int i = 0; i < static_cast<int>(boxes._xmin.size()); ++i){
+    if(boxes._xmin[i] <= query._xmax && boxes._xmax[i] >= query._xmin &&
+       boxes._ymin[i] <= query._ymax && boxes._ymax[i] >= query._ymin)
+    {
+      hits[hitCount++] = i;
+    }
+  }
+  return hitCount;
+}
+
+//
+// Returns the mean time of a single call in nanoseconds.
+//
+template<typename Fn>
+static double timeCalls(int iterations, Fn fn)
+{
+  using clock = std::chrono::steady_clock;
+  auto start = clock::now();
+  for(int i = 0; i < iterations; ++i)
+    fn(i);
+  auto end = clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+  if(iterations <= 0)
+    iterations = 2000;
+
+  std::printf("aabb kernel: %s\n", getAABBKernelName());
+  std::printf("%10s %14s %14s %14s %10s\n", "boxes", "reference", "contiguous", "indexed", "speedup");
+  std::printf("%10s %14s %14s %14s %10s\n", "", "(Mboxes/s)", "(Mboxes/s)", "(Mboxes/s)", "");
+
+  std::mt19937 rng {1981};
+
+  for(int count : {1000, 10000, 100000}){
+    BoxSet boxes = makeBoxes(count, rng);
+    AABBArrays arrays = boxes.getArrays();
+
+    std::vector<int> indices(count);
+    for(int i = 0; i < count; ++i)
+      indices[i] = i;
+
+    std::vector<int> hits(count);
+    std::vector<int> expected(count);
+
+    //
+    // queries walk across the world so each iteration sees different hits.
+    //
+    std::vector<pxr::AABB> queries {};
+    for(int i = 0; i < 64; ++i){
+      float x = static_cast<float>((i * 37) % worldSize._x);
+      float y = static_cast<float>((i * 53) % worldSize._y);
+      pxr::AABB query {};
+      query._xmin = x - 2.f;
+      query._xmax = x + 2.f;
+      query._ymin = y - 8.f;
+      query._ymax = y - 6.f;
+      queries.push_back(query);
+    }
+
+    for(const auto& query : queries){
+      int expectedCount = referenceIntersections(query, boxes, expected.data());
+      int contiguousCount = findAABBIntersections(query, arrays, count, hits.data());
+      bool match = expectedCount == contiguousCount &&
+                   std::equal(expected.begin(), expected.begin() + expectedCount, hits.begin());
+      int indexedCount = findAABBIntersections(query, arrays, indices.data(), count, hits.data());
+      match = match && expectedCount == indexedCount &&
+              std::equal(expected.begin(), expected.begin() + expectedCount, hits.begin());
+      if(!match){
+        std::fprintf(stderr, "kernel results differ from reference at %d boxes\n", count);
+        return EXIT_FAILURE;
+      }
+    }
+
+    int scaledIterations = std::max(1, static_cast<int>((iterations * 1000LL) / count));
+    volatile int sink {0};
+
+    double referenceNs = timeCalls(scaledIterations, [&](int i){
+      sink = referenceIntersections(queries[i % queries.size()], boxes, expected.data());
+    });
+    double contiguousNs = timeCalls(scaledIterations, [&](int i){
+      sink = findAABBIntersections(queries[i % queries.size()], arrays, count, hits.data());
+    });
+    double indexedNs = timeCalls(scaledIterations, [&](int i){
+      sink = findAABBIntersections(queries[i % queries.size()], arrays, indices.data(), count,
+                                   hits.data());
+    });
+
+    auto throughput = [count](double ns){return (count / ns) * 1000.0;};
+
+    std::printf("%10d %14.1f %14.1f %14.1f %9.2fx\n", count, throughput(referenceNs),
+                throughput(contiguousNs), throughput(indexedNs), referenceNs / contiguousNs);
+  }
+
+  return EXIT_SUCCESS;
+}
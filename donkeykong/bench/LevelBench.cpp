@@ -0,0 +1,145 @@
+//
+// Measures the cost of a level tick. Each level is loaded through Level::load and stepped
+// headless (Level::onUpdate then Level::onDraw) for a fixed number of ticks at 60Hz; the
+// time per tick is reported in total and split into the phases timed by the Profiler.
+//
+// Mario is driven by a fixed input pattern (run right, run left, jump) so that he moves
+// through the level. If he dies the level is reset, as PlayState does.
+//
+// usage: dk_level_bench <ticks> <level> [level ...]
+//
+// Levels are named as in dkconfig.xml; generate stress levels with dk_levelgen. Must be run
+// from the game root dir (as the game is).
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include "Headless.h"
+#include "AnimationFactory.h"
+#include "PropFactory.h"
+#include "MarioFactory.h"
+#include "ResourceCache.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "RenderBuffer.h"
+#include "Level.h"
+
+static constexpr float tickDuration {1.f / 60.f};
+static constexpr int screenid {0};
+static constexpr int backgroundScreenid {1};
+
+//
+// Sets the keys held for the given tick; each segment of the pattern lasts 2 seconds.
+//
+static void applyInputPattern(const ControlScheme& controls, long tick)
+{
+  int segment = (tick / 120) % 3;
+  headless::setKeyDown(controls._runRightKey, segment == 0);
+  headless::setKeyDown(controls._runLeftKey, segment == 1);
+  headless::setKeyDown(controls._jumpKey, segment == 2 && (tick % 30) == 0);
+}
+
+static bool runLevel(const std::string& levelName, long ticks, 
+                     std::shared_ptr<const ControlScheme> controls)
+{
+  Random::seed(1);
+  headless::releaseAllKeys();
+
+  Level level {};
+  RenderBuffer renderBuffer {};
+
+  auto loadStart = std::chrono::steady_clock::now();
+  if(!level.load(levelName)){
+    std::fprintf(stderr, "failed to load level '%s'\n", levelName.c_str());
+    return false;
+  }
+  auto loadEnd = std::chrono::steady_clock::now();
+
+  level.onInit(controls, backgroundScreenid);
+
+  Profiler::clear();
+
+  int resets {0};
+  double now {0.0};
+
+  auto runStart = std::chrono::steady_clock::now();
+  for(long tick = 0; tick < ticks; ++tick){
+    applyInputPattern(*controls, tick);
+    level.onUpdate(now, tickDuration);
+    renderBuffer.clear();
+    level.onDraw(renderBuffer, screenid);
+    renderBuffer.execute();
+    headless::endTick();
+    Profiler::endFrame();
+    if(level.isOver()){
+      level.reset();
+      ++resets;
+    }
+    now += tickDuration;
+  }
+  auto runEnd = std::chrono::steady_clock::now();
+
+  auto toNanoseconds = [](std::chrono::steady_clock::duration d){
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+  };
+
+  std::printf("%s: %ld ticks, load %.1f ms, %d resets\n", levelName.c_str(), ticks, 
+              toNanoseconds(loadEnd - loadStart) / 1e6, resets);
+
+  double phaseSum {0.0};
+  for(int phase = 0; phase < Profiler::PHASE_COUNT; ++phase){
+    const auto& stats = Profiler::getPhaseStats(static_cast<Profiler::Phase>(phase));
+    if(stats._sampleCount == 0)
+      continue; // phases outside the level (e.g. the PlayState update) are not run.
+    double nsPerTick = static_cast<double>(stats._totalNanoseconds) / ticks;
+    phaseSum += nsPerTick;
+    std::printf("  %-12s %12.0f ns/tick\n", Profiler::getPhaseName(static_cast<Profiler::Phase>(phase)), nsPerTick);
+  }
+  std::printf("  %-12s %12.0f ns/tick\n", "other", (toNanoseconds(runEnd - runStart) / ticks) - phaseSum);
+  std::printf("  %-12s %12.0f ns/tick\n", "total", toNanoseconds(runEnd - runStart) / ticks);
+
+  level.unload();
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 3){
+    std::fprintf(stderr, "usage: dk_level_bench <ticks> <level> [level ...]\n");
+    return EXIT_FAILURE;
+  }
+
+  long ticks = std::strtol(argv[1], nullptr, 10);
+  if(ticks < 1){
+    std::fprintf(stderr, "ticks must be positive\n");
+    return EXIT_FAILURE;
+  }
+
+  ResourceCache::initialize();
+  if(!AnimationFactory::initialize() || !PropFactory::initialize() || !MarioFactory::initialize()){
+    std::fprintf(stderr, "failed to initialize factories\n");
+    return EXIT_FAILURE;
+  }
+
+  auto controls = std::make_shared<ControlScheme>();
+  controls->_runLeftKey = pxr::input::KEY_LEFT;
+  controls->_runRightKey = pxr::input::KEY_RIGHT;
+  controls->_jumpKey = pxr::input::KEY_SPACE;
+  controls->_climbUpKey = pxr::input::KEY_UP;
+  controls->_climbDownKey = pxr::input::KEY_DOWN;
+
+  int status {EXIT_SUCCESS};
+  for(int i = 2; i < argc; ++i)
+    if(!runLevel(argv[i], ticks, controls))
+      status = EXIT_FAILURE;
+
+  PropFactory::shutdown();
+  AnimationFactory::shutdown();
+  MarioFactory::shutdown();
+  ResourceCache::shutdown();
+
+  return status;
+}
@@ -0,0 +1,69 @@
+#ifndef _PIXIRETRO_GAME_HEADLESS_H_
+#define _PIXIRETRO_GAME_HEADLESS_H_
+
+#include <cstdint>
+#include "pixiretro/pxr_input.h"
+#include "pixiretro/pxr_log.h"
+#include "Rasterizer.h"
+
+//
+// Controls for the headless implementation of the engine calls used by the game core. The
+// headless backend replaces the pxr::gfx, pxr::sfx, pxr::input, pxr::rand, pxr::log and
+// pxr::io calls with versions which need no window, audio device or engine library, thus
+// levels can be loaded and stepped on machines without a display (benchmarks, soak tests).
+//
+// Graphics and sound calls only count unless the rasterizer is enabled, in which case
+// graphics calls also draw to CPU framebuffers. Resource loads hand out unique keys. Input
+// is driven by the caller via setKeyDown and endTick. The game's random numbers come from
+// Random, which the caller seeds so runs are repeatable.
+//
+namespace headless
+{
+
+//
+// Counts of the calls made to the stubbed graphics and sound modules.
+//
+struct CallStats
+{
+  int64_t _spriteDraws;
+  int64_t _rectangleDraws;
+  int64_t _textDraws;
+  int64_t _screenClears;
+  int64_t _soundPlays;
+};
+
+//
+// Sets the state of a key as seen by pxr::input::isKeyDown. A key reads as pressed if it is
+// down now but was not down before the last call to endTick.
+//
+void setKeyDown(pxr::input::KeyCode key, bool isDown);
+
+//
+// Call at the end of every tick to advance key press detection.
+//
+void endTick();
+
+void releaseAllKeys();
+
+//
+// Makes the pxr::gfx calls draw with a CPU rasterizer; spritesheets loaded from then on are
+// decoded for it. Must be called before any screen is created.
+//
+void enableRasterizer();
+
+//
+// The rasterizer the pxr::gfx calls draw with, or nullptr if not enabled.
+//
+Rasterizer* getRasterizer();
+
+const CallStats& getCallStats();
+void resetCallStats();
+
+//
+// Messages with a level greater (less severe) than 'level' are not printed. Defaults to WARN.
+//
+void setLogLevel(pxr::log::Level level);
+
+} // namespace headless
+
+#endif
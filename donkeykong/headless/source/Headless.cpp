@@ -0,0 +1,31 @@
+#include "HeadlessState.h"
+
+namespace headless
+{
+
+CallStats callStats {0, 0, 0, 0, 0};
+
+std::unique_ptr<Rasterizer> rasterizer {nullptr};
+
+void enableRasterizer()
+{
+  if(rasterizer == nullptr)
+    rasterizer = std::unique_ptr<Rasterizer>{new Rasterizer()};
+}
+
+Rasterizer* getRasterizer()
+{
+  return rasterizer.get();
+}
+
+const CallStats& getCallStats()
+{
+  return callStats;
+}
+
+void resetCallStats()
+{
+  callStats = CallStats{0, 0, 0, 0, 0};
+}
+
+} // namespace headless
@@ -0,0 +1,103 @@
+#include <cassert>
+#include "pixiretro/pxr_gfx.h"
+#include "SpritesheetData.h"
+#include "HeadlessState.h"
+
+//
+// Stands in for the pxr::gfx module; draw calls are counted, and forwarded to the rasterizer
+// if it is enabled. Resource keys are unique for the lifetime of the process, as the
+// engine's are.
+//
+namespace pxr
+{
+namespace gfx
+{
+
+static ResourceKey_t nextResourceKey {0};
+static int nextScreenid {0};
+
+ResourceKey_t loadSpritesheet(const char* name)
+{
+  ResourceKey_t key = nextResourceKey++;
+  if(headless::rasterizer != nullptr){
+    auto data = std::make_shared<SpritesheetData>();
+    if(loadSpritesheetData(name, data.get()))
+      headless::rasterizer->addSpritesheet(key, std::move(data));
+  }
+  return key;
+}
+
+void unloadSpritesheet(ResourceKey_t key)
+{
+  if(headless::rasterizer != nullptr)
+    headless::rasterizer->removeSpritesheet(key);
+}
+
+ResourceKey_t loadFont(const char* name)
+{
+  (void)name;
+  return nextResourceKey++;
+}
+
+void unloadFont(ResourceKey_t key)
+{
+  (void)key;
+}
+
+void drawText(Vector2i position, const std::string& text, int fontKey, int screenid)
+{
+  (void)position;
+  (void)text;
+  (void)fontKey;
+  (void)screenid;
+  ++headless::callStats._textDraws;
+}
+
+int createScreen(Vector2i size)
+{
+  if(headless::rasterizer != nullptr){
+    int screenid = headless::rasterizer->createScreen(size);
+    assert(screenid == nextScreenid);
+    (void)screenid;
+  }
+  return nextScreenid++;
+}
+
+void clearScreenShade(int shade, int screenid)
+{
+  if(headless::rasterizer != nullptr)
+    headless::rasterizer->clearScreenShade(shade, screenid);
+  ++headless::callStats._screenClears;
+}
+
+void clearScreenTransparent(int screenid)
+{
+  if(headless::rasterizer != nullptr)
+    headless::rasterizer->clearScreenTransparent(screenid);
+  ++headless::callStats._screenClears;
+}
+
+void drawSprite(Vector2i position, ResourceKey_t spritesheetKey, SpriteId_t spriteid, int screenid,
+                bool mirrorX, bool mirrorY)
+{
+  if(headless::rasterizer != nullptr)
+    headless::rasterizer->drawSprite(position, spritesheetKey, spriteid, screenid, mirrorX, mirrorY);
+  ++headless::callStats._spriteDraws;
+}
+
+void drawFillRectangle(iRect rect, Color4u color, int screenid)
+{
+  if(headless::rasterizer != nullptr)
+    headless::rasterizer->drawFillRectangle(rect, color, screenid);
+  ++headless::callStats._rectangleDraws;
+}
+
+void drawBorderRectangle(iRect rect, Color4u color, int screenid)
+{
+  if(headless::rasterizer != nullptr)
+    headless::rasterizer->drawBorderRectangle(rect, color, screenid);
+  ++headless::callStats._rectangleDraws;
+}
+
+} // namespace gfx
+} // namespace pxr
@@ -0,0 +1,77 @@
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "pixiretro/pxr_input.h"
+#include "Headless.h"
+
+//
+// Stands in for the pxr::input module; key states are set by the caller rather than by
+// window events.
+//
+static std::unordered_set<int> keysDown {};
+static std::unordered_set<int> keysDownLastTick {};
+
+namespace headless
+{
+
+void setKeyDown(pxr::input::KeyCode key, bool isDown)
+{
+  if(isDown)
+    keysDown.insert(key);
+  else
+    keysDown.erase(key);
+}
+
+void endTick()
+{
+  keysDownLastTick = keysDown;
+}
+
+void releaseAllKeys()
+{
+  keysDown.clear();
+  keysDownLastTick.clear();
+}
+
+} // namespace headless
+
+namespace pxr
+{
+namespace input
+{
+
+bool isKeyDown(KeyCode key)
+{
+  return keysDown.count(key) != 0;
+}
+
+bool isKeyPressed(KeyCode key)
+{
+  return keysDown.count(key) != 0 && keysDownLastTick.count(key) == 0;
+}
+
+bool isKeyReleased(KeyCode key)
+{
+  return keysDown.count(key) == 0 && keysDownLastTick.count(key) != 0;
+}
+
+KeyCode keyStringToKeyCode(const std::string& keyString)
+{
+  static const std::unordered_map<std::string, KeyCode> keyCodes {
+    {"KEY_a", KEY_a}, {"KEY_b", KEY_b}, {"KEY_c", KEY_c}, {"KEY_d", KEY_d},
+    {"KEY_e", KEY_e}, {"KEY_f", KEY_f}, {"KEY_g", KEY_g}, {"KEY_h", KEY_h},
+    {"KEY_i", KEY_i}, {"KEY_j", KEY_j}, {"KEY_k", KEY_k}, {"KEY_l", KEY_l},
+    {"KEY_m", KEY_m}, {"KEY_n", KEY_n}, {"KEY_o", KEY_o}, {"KEY_p", KEY_p},
+    {"KEY_q", KEY_q}, {"KEY_r", KEY_r}, {"KEY_s", KEY_s}, {"KEY_t", KEY_t},
+    {"KEY_u", KEY_u}, {"KEY_v", KEY_v}, {"KEY_w", KEY_w}, {"KEY_x", KEY_x},
+    {"KEY_y", KEY_y}, {"KEY_z", KEY_z}, {"KEY_SPACE", KEY_SPACE},
+    {"KEY_BACKSPACE", KEY_BACKSPACE}, {"KEY_ENTER", KEY_ENTER}, {"KEY_LEFT", KEY_LEFT},
+    {"KEY_RIGHT", KEY_RIGHT}, {"KEY_UP", KEY_UP}, {"KEY_DOWN", KEY_DOWN}
+  };
+
+  auto search = keyCodes.find(keyString);
+  return search != keyCodes.end() ? search->second : KEY_COUNT;
+}
+
+} // namespace input
+} // namespace pxr
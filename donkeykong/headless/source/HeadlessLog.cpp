@@ -0,0 +1,46 @@
+#include <iostream>
+#include "pixiretro/pxr_log.h"
+#include "Headless.h"
+
+//
+// Stands in for the pxr::log module; messages go to stderr.
+//
+static pxr::log::Level maxLevel {pxr::log::WARN};
+
+static const char* levelToString(pxr::log::Level level)
+{
+  switch(level){
+    case pxr::log::ERROR: return "error";
+    case pxr::log::WARN: return "warning";
+    case pxr::log::INFO: return "info";
+    default: return "fatal";
+  }
+}
+
+namespace headless
+{
+
+void setLogLevel(pxr::log::Level level)
+{
+  maxLevel = level;
+}
+
+} // namespace headless
+
+namespace pxr
+{
+namespace log
+{
+
+void log(Level level, const char* msg, const std::string& addendum)
+{
+  if(level > maxLevel)
+    return;
+  std::cerr << levelToString(level) << ": " << msg;
+  if(!addendum.empty())
+    std::cerr << " : " << addendum;
+  std::cerr << std::endl;
+}
+
+} // namespace log
+} // namespace pxr
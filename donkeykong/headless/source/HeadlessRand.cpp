@@ -0,0 +1,45 @@
+#include <cstdint>
+#include "pixiretro/pxr_rand.h"
+#include "Headless.h"
+
+//
+// Stands in for the pxr::rand module with an xorshift64* generator. The game itself draws
+// from Random, which is seeded by the caller.
+//
+static constexpr uint64_t defaultSeed {0x9e3779b97f4a7c15};
+
+static uint64_t state {defaultSeed};
+
+static uint64_t nextRandom()
+{
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 0x2545f4914f6cdd1d;
+}
+
+namespace pxr
+{
+namespace rand
+{
+
+int uniformSignedInt(int lo, int hi)
+{
+  uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(hi) - lo) + 1;
+  return static_cast<int>(lo + static_cast<int64_t>(nextRandom() % range));
+}
+
+unsigned uniformUnsignedInt(unsigned lo, unsigned hi)
+{
+  uint64_t range = static_cast<uint64_t>(hi - lo) + 1;
+  return lo + static_cast<unsigned>(nextRandom() % range);
+}
+
+double uniformReal(double lo, double hi)
+{
+  double unit = static_cast<double>(nextRandom() >> 11) * (1.0 / 9007199254740992.0); // [0, 1)
+  return lo + (unit * (hi - lo));
+}
+
+} // namespace rand
+} // namespace pxr
@@ -0,0 +1,38 @@
+#include "pixiretro/pxr_sfx.h"
+#include "HeadlessState.h"
+
+//
+// Stands in for the pxr::sfx module; no sound is played, plays are only counted.
+//
+namespace pxr
+{
+namespace sfx
+{
+
+static ResourceKey_t nextSoundKey {0};
+
+ResourceKey_t loadSound(const char* name)
+{
+  (void)name;
+  return nextSoundKey++;
+}
+
+void unloadSound(ResourceKey_t key)
+{
+  (void)key;
+}
+
+void playSound(ResourceKey_t key, bool loop)
+{
+  (void)key;
+  (void)loop;
+  ++headless::callStats._soundPlays;
+}
+
+void stopSound(ResourceKey_t key)
+{
+  (void)key;
+}
+
+} // namespace sfx
+} // namespace pxr
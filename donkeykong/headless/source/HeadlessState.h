@@ -0,0 +1,19 @@
+#ifndef _PIXIRETRO_GAME_HEADLESS_STATE_H_
+#define _PIXIRETRO_GAME_HEADLESS_STATE_H_
+
+#include <memory>
+#include "Headless.h"
+
+//
+// State shared between the headless module implementations; not part of the public interface.
+//
+namespace headless
+{
+
+extern CallStats callStats;
+
+extern std::unique_ptr<Rasterizer> rasterizer;
+
+} // namespace headless
+
+#endif
@@ -0,0 +1,82 @@
+#include "pixiretro/pxr_xml.h"
+#include "pixiretro/pxr_log.h"
+
+//
+// The engine's xml helpers (pxr::io) reimplemented over tinyxml2, with the same logging.
+//
+
+//
+// log strings.
+//
+static constexpr const char* msg_parsing_xml = "parsing xml asset file";
+static constexpr const char* msg_parse_error = "parsing error in xml file";
+static constexpr const char* msg_read_attribute_fail = "failed to read xml attribute";
+static constexpr const char* msg_find_element_fail = "failed to find xml element";
+static constexpr const char* msg_tinyxml2_error_name = "tinyxml2 error name";
+static constexpr const char* msg_tinyxml2_error_desc = "tinyxml2 error desc";
+
+using namespace tinyxml2;
+
+namespace pxr
+{
+namespace io
+{
+
+bool parseXmlDocument(XMLDocument* doc, const std::string& xmlpath)
+{
+  log::log(log::INFO, msg_parsing_xml, xmlpath);
+  doc->LoadFile(xmlpath.c_str());
+  if(doc->Error()){
+    log::log(log::ERROR, msg_parse_error, xmlpath);
+    log::log(log::ERROR, msg_tinyxml2_error_name, doc->ErrorName());
+    log::log(log::ERROR, msg_tinyxml2_error_desc, doc->ErrorStr());
+    return false;
+  }
+  return true;
+}
+
+bool extractChildElement(XMLNode* parent, XMLElement** child, const char* childname)
+{
+  *child = parent->FirstChildElement(childname);
+  if(*child == nullptr){
+    log::log(log::ERROR, msg_find_element_fail, childname);
+    return false;
+  }
+  return true;
+}
+
+bool extractIntAttribute(XMLElement* element, const char* attribute, int* value)
+{
+  XMLError xmlerror = element->QueryIntAttribute(attribute, value);
+  if(xmlerror != XML_SUCCESS){
+    log::log(log::ERROR, msg_read_attribute_fail, attribute);
+    log::log(log::ERROR, msg_tinyxml2_error_name, XMLDocument::ErrorIDToName(xmlerror));
+    return false;
+  }
+  return true;
+}
+
+bool extractFloatAttribute(XMLElement* element, const char* attribute, float* value)
+{
+  XMLError xmlerror = element->QueryFloatAttribute(attribute, value);
+  if(xmlerror != XML_SUCCESS){
+    log::log(log::ERROR, msg_read_attribute_fail, attribute);
+    log::log(log::ERROR, msg_tinyxml2_error_name, XMLDocument::ErrorIDToName(xmlerror));
+    return false;
+  }
+  return true;
+}
+
+bool extractStringAttribute(XMLElement* element, const char* attribute, const char** value)
+{
+  XMLError xmlerror = element->QueryStringAttribute(attribute, value);
+  if(xmlerror != XML_SUCCESS){
+    log::log(log::ERROR, msg_read_attribute_fail, attribute);
+    log::log(log::ERROR, msg_tinyxml2_error_name, XMLDocument::ErrorIDToName(xmlerror));
+    return false;
+  }
+  return true;
+}
+
+} // namespace io
+} // namespace pxr
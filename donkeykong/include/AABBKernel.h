@@ -0,0 +1,48 @@
+#ifndef _PIXIRETRO_GAME_AABBKERNEL_H_
+#define _PIXIRETRO_GAME_AABBKERNEL_H_
+
+#include "pixiretro/pxr_collision.h"
+
+//
+// Batched intersection tests of a single query box against many boxes stored as separate
+// coordinate arrays (structure-of-arrays). The tests are vectorized with AVX2 or SSE2 where
+// the cpu supports them, with a scalar fallback otherwise; the implementation is chosen once
+// at runtime.
+//
+// Boxes which touch are considered intersecting.
+//
+
+//
+// Pointers to the four coordinate arrays of a set of boxes. Element i of each array are the
+// bounds of box i.
+//
+struct AABBArrays
+{
+  const float* _xmin;
+  const float* _xmax;
+  const float* _ymin;
+  const float* _ymax;
+};
+
+//
+// Tests the query box against boxes [0, count) and writes the indices of all boxes which
+// intersect the query to 'hits' in ascending order. Returns the number of hits written.
+//
+// The hits array must have space for 'count' elements.
+//
+int findAABBIntersections(const pxr::AABB& query, const AABBArrays& boxes, int count, int* hits);
+
+//
+// As above but only tests the boxes whose indices are listed in 'indices' (count of them).
+// Hits are written as box indices (not positions in 'indices') in the order they appear in
+// 'indices'.
+//
+int findAABBIntersections(const pxr::AABB& query, const AABBArrays& boxes, const int* indices,
+                          int count, int* hits);
+
+//
+// The name of the implementation in use: "avx2", "sse2" or "scalar".
+//
+const char* getAABBKernelName();
+
+#endif
@@ -4,6 +4,8 @@
 #include <memory>
 #include "pixiretro/pxr_gfx.h"
 #include "pixiretro/pxr_vec.h"
+#include "SpriteMask.h"
+#include "DrawList.h"
 
 class AnimationFactory;
 struct AnimationDefinition;
@@ -47,10 +49,10 @@ public:
   void onUpdate(float dt);
 
   //
-  // Draws the currently active frame (a sprite) to a screen at a specified position. The
-  // position is taken as the position of the sprite origin.
+  // Pushes a draw of the currently active frame (a sprite) at a specified position to a draw
+  // list. The position is taken as the position of the sprite origin.
   //
-  void onDraw(pxr::Vector2i position, int screenid);
+  void onDraw(pxr::Vector2i position, int layer, DrawList& drawList);
 
   //
   // Resets the animation to start from frame 0.
@@ -59,6 +61,12 @@ public:
 
   bool isMirroringX() const {return _mirrorX;}
   bool isMirroringY() const {return _mirrorY;} 
+
+  //
+  // Returns true if the animation always shows the same frame.
+  //
+  bool isStatic() const {return _def->_mode == Mode::STATIC || _def->_frames.size() == 1;}
+
   void setMirrorX(bool mirror);
   void setMirrorY(bool mirror);
 
@@ -70,6 +78,26 @@ public:
   pxr::gfx::ResourceKey_t getSpritesheetKey() const {return _def->_spritesheetKey;}
   pxr::gfx::SpriteId_t getSpriteId() const {return _def->_frames[_frameNo];}
 
+  //
+  // The opacity mask of the current frame's sprite.
+  //
+  const SpriteMask& getSpriteMask() const {return *(_def->_frameMasks[_frameNo]);}
+
+  //
+  // The playback state of an animation; restoring it to an animation of the same definition
+  // returns it to the frame and time it was captured at.
+  //
+  struct Snapshot
+  {
+    int _frameNo;
+    float _clock;
+    bool _mirrorX;
+    bool _mirrorY;
+  };
+
+  Snapshot getSnapshot() const {return Snapshot{_frameNo, _clock, _mirrorX, _mirrorY};}
+  void restore(const Snapshot& snapshot);
+
 public:
 
   //
@@ -85,20 +113,29 @@ public:
     //
     //   - name != "" (empty string)
     //   - frequency > 0
+    //   - size of frame masks == size of frames
     //
-    Definition(std::string                       name,
-               Mode                              mode,
-               pxr::gfx::ResourceKey_t           spritesheetKey,
-               std::vector<pxr::gfx::SpriteId_t> frames,
-               float                             frequency,
-               bool                              baseMirrorX,
-               bool                              baseMirrorY 
+    Definition(std::string                                    name,
+               Mode                                           mode,
+               pxr::gfx::ResourceKey_t                        spritesheetKey,
+               std::vector<pxr::gfx::SpriteId_t>              frames,
+               std::vector<std::shared_ptr<const SpriteMask>> frameMasks,
+               float                                          frequency,
+               bool                                           baseMirrorX,
+               bool                                           baseMirrorY 
     );
                
     std::string _name;
     Mode _mode;
     pxr::gfx::ResourceKey_t _spritesheetKey;
     std::vector<pxr::gfx::SpriteId_t> _frames;
+
+    //
+    // The opacity mask of the sprite of each frame; masks are shared between all frames (of
+    // all animations) which use the same sprite.
+    //
+    std::vector<std::shared_ptr<const SpriteMask>> _frameMasks;
+
     float _frequency;
     float _period;
 
@@ -2,7 +2,11 @@
 #define _PIXIRETRO_GAME_ANIMATION_FACTORY_H_
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include "Animation.h"
+#include "SpriteMask.h"
+#include "pixiretro/pxr_xml.h"
 
 //
 // Singleton class to instantiate animations. Responsible for loading and maintaining
@@ -34,17 +38,31 @@ public:
   //
   static bool initialize();
 
+  //
+  // Reloads the animations definitions file, keeping the current definitions if it fails to
+  // load. Spritesheets not used before are loaded; none are unloaded.
+  //
+  // Existing animations keep the definition they were made from; only animations made after
+  // the reload use the new definitions.
+  //
+  static bool reload();
+
   //
   // Must call to free memory used by the factory singleton instance.
   //
   static void shutdown();
 
   //
-  // Makes an instance of an animation type.
+  // Returns the handle of the animation type with name 'animationName', or -1 (and logs) if
+  // there is no such type. Handles are dense indices assigned at load and are stable across
+  // reloads, so resolve names once at load and make animations from handles thereafter.
   //
-  // If no such animation type with name 'animationName' exists the function asserts(0).
+  static int findAnimation(const std::string& animationName);
+
+  //
+  // Makes an instance of an animation type from its handle; no strings are looked up.
   //
-  static Animation makeAnimation(const std::string& animationName);
+  static Animation makeAnimation(int handle);
 
 private:
   static std::unique_ptr<AnimationFactory> instance;
@@ -54,8 +72,49 @@ private:
 
   bool loadAnimationDefinitions();
 
+  //
+  // Points the handle of every definition in _defs at it, assigning handles to new names.
+  //
+  void indexDefinitions();
+
+  //
+  // Loads every spritesheet used by the animations which is not already loaded, then builds
+  // the masks of all their sprites on a pool of worker threads. Headless builds also decode
+  // a game side copy of each spritesheet (SpritesheetData) on the workers.
+  //
+  bool loadSpritesheets(tinyxml2::XMLElement* xmlanimations);
+
+  //
+  // Returns the mask of a sprite, building it on first request from the engine's decoded
+  // spritesheet (or the game side copy in headless builds). Returns nullptr if the
+  // spritesheet is not loaded or has no such sprite.
+  //
+  std::shared_ptr<const SpriteMask> getSpriteMask(const std::string& spritesheetName, 
+                                                  pxr::gfx::SpriteId_t spriteid);
+
 private:
+  //
+  // The definitions by name as last loaded; only used at load.
+  //
   std::unordered_map<std::string, std::shared_ptr<Animation::Definition>> _defs;
+
+  //
+  // The definitions by handle. Names removed by a reload keep their handle and definition.
+  //
+  std::unordered_map<std::string, int> _handles;
+  std::vector<std::shared_ptr<const Animation::Definition>> _handleDefs;
+
+  //
+  // The spritesheets acquired from the resource cache, one reference each however many
+  // animations use them.
+  //
+  std::unordered_map<std::string, pxr::gfx::ResourceKey_t> _spritesheetKeys;
+
+  //
+  // Masks are only needed while loading definitions; they persist via the definitions which
+  // reference them.
+  //
+  std::unordered_map<std::string, std::vector<std::shared_ptr<const SpriteMask>>> _spriteMasks;
 };
 
 #endif
@@ -0,0 +1,241 @@
+#ifndef _PIXIRETRO_GAME_ASSETPACK_H_
+#define _PIXIRETRO_GAME_ASSETPACK_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+//
+// A binary pack of the prop definitions (gameprops.xml) and level files, compiled offline by
+// dk_packc. At runtime the pack is memory mapped and its records read in place, so the prop
+// factory and levels are built without parsing any xml.
+//
+// The pack is a header followed by arrays of fixed size little-endian records; every record
+// field is 4 bytes and 4 byte aligned. Cross-references within the pack are resolved by the
+// compiler; a level prop refers to its definition by index and states refer to their points
+// and sounds by index. Animations are not packed, so a state names its animation and the
+// name is resolved through the animation factory once, when the definitions are built.
+//
+// The pack records the size and modification time of every xml file it was compiled from.
+// If no pack is present, it is the wrong version, or any of its source files has changed
+// since it was compiled, the game falls back to the xml files. Hot reloading a packed source
+// closes the pack for the same reason.
+//
+namespace pack
+{
+
+static constexpr char magic[4] {'D', 'K', 'P', 'K'};
+static constexpr uint32_t version {3};
+
+//
+// A range of records in one of the pack arrays.
+//
+struct Range
+{
+  uint32_t _first;
+  uint32_t _count;
+};
+
+//
+// A string in the string table; an offset into the character data and a length. Strings are
+// also nul terminated in the character data so may be used as c strings.
+//
+struct String
+{
+  uint32_t _offset;
+  uint32_t _length;
+};
+
+struct Point
+{
+  float _x;
+  float _y;
+};
+
+struct SpeedPoint
+{
+  float _value;
+  float _duration;
+};
+
+enum StateTransitionMode : uint32_t
+{
+  TRANSITION_FORWARD,
+  TRANSITION_RANDOM
+};
+
+enum StateFlags : uint32_t
+{
+  FLAG_SUPPORT = 1 << 0,
+  FLAG_LADDER = 1 << 1,
+  FLAG_CONVEYOR = 1 << 2,
+  FLAG_KILLER = 1 << 3
+};
+
+struct State
+{
+  float _duration;
+  Range _positions;   // into the points array.
+  Range _speeds;      // into the speed points array.
+  Range _sounds;      // into the sound names array.
+  float _boxX;
+  float _boxY;
+  float _boxW;
+  float _boxH;
+  float _supportHeight;
+  float _ladderHeight;
+  float _conveyorVelocityX;
+  float _conveyorVelocityY;
+  int32_t _killerDamage;
+  uint32_t _flags;
+  uint32_t _animationName; // string index.
+};
+
+struct PropDefinition
+{
+  uint32_t _name;                 // string index.
+  uint32_t _stateTransitionMode;  // pack::StateTransitionMode.
+  int32_t _drawLayer;
+  Range _states;
+};
+
+struct LevelProp
+{
+  uint32_t _definition;  // prop definition index.
+  float _x;
+  float _y;
+};
+
+struct Level
+{
+  uint32_t _name;  // string index.
+  float _marioSpawnX;
+  float _marioSpawnY;
+  Range _props;
+};
+
+//
+// A file (w.r.t the game root dir) the pack was compiled from, as it was when compiled.
+//
+struct Source
+{
+  uint32_t _path;       // string index.
+  uint32_t _size;
+  uint32_t _mtimeLow;   // modification time in nanoseconds since the epoch, split in words.
+  uint32_t _mtimeHigh;
+};
+
+//
+// The sections of the pack in file order.
+//
+enum Section
+{
+  SECTION_CHARS,
+  SECTION_STRINGS,
+  SECTION_POINTS,
+  SECTION_SPEED_POINTS,
+  SECTION_SOUND_NAMES,
+  SECTION_STATES,
+  SECTION_PROP_DEFINITIONS,
+  SECTION_LEVEL_PROPS,
+  SECTION_LEVELS,
+  SECTION_SOURCES,
+  SECTION_COUNT
+};
+
+//
+// Byte offset (from the start of the file) and record count of each section.
+//
+struct Header
+{
+  char _magic[4];
+  uint32_t _version;
+  Range _sections[SECTION_COUNT];
+};
+
+static_assert(sizeof(Range) == 8);
+static_assert(sizeof(String) == 8);
+static_assert(sizeof(State) == 72);
+static_assert(sizeof(PropDefinition) == 20);
+static_assert(sizeof(LevelProp) == 12);
+static_assert(sizeof(Level) == 20);
+static_assert(sizeof(Source) == 16);
+static_assert(sizeof(Header) == 8 + (8 * SECTION_COUNT));
+
+} // namespace pack
+
+//
+// The memory mapped pack; a singleton like the factories.
+//
+class AssetPack final
+{
+public:
+
+  static constexpr const char* PACK_FILE_PATH {"assets/"};
+  static constexpr const char* PACK_FILE_NAME {"assets"};
+  static constexpr const char* PACK_FILE_EXTENSION {".dkpack"};
+
+  ~AssetPack();
+
+  //
+  // Maps the pack file if it exists. Returns true if a valid and current pack was mapped, else
+  // false (a missing pack is logged at INFO, a stale one at WARN, an invalid one at ERROR) and
+  // the game uses the xml.
+  //
+  static bool initialize();
+
+  static void shutdown();
+
+  //
+  // Is a pack mapped.
+  //
+  static bool isOpen();
+
+  //
+  // Accessors of the pack arrays; only valid while a pack is mapped.
+  //
+  template<typename T>
+  static const T* getRecords(pack::Section section, uint32_t* count = nullptr);
+
+  static const char* getString(uint32_t index);
+
+  //
+  // Returns the index of the level with 'name' or -1 if the pack does not contain it.
+  //
+  static int findLevel(const std::string& name);
+
+  //
+  // Reads the size and modification time (nanoseconds since the epoch) of a file as recorded
+  // for pack sources. Returns false if the file cannot be stat'd.
+  //
+  static bool statFile(const std::string& path, uint32_t* size, uint64_t* mtime);
+
+private:
+  static std::unique_ptr<AssetPack> instance;
+
+private:
+  AssetPack() = default;
+
+  bool map(const std::string& path);
+  bool validate(const std::string& path) const;
+
+  //
+  // Are all the pack's source files unchanged since it was compiled.
+  //
+  bool isCurrent() const;
+
+  const void* getSection(pack::Section section, uint32_t* count) const;
+
+private:
+  const uint8_t* _bytes {nullptr};
+  size_t _size {0};
+};
+
+template<typename T>
+const T* AssetPack::getRecords(pack::Section section, uint32_t* count)
+{
+  return static_cast<const T*>(instance->getSection(section, count));
+}
+
+#endif
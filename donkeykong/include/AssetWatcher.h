@@ -0,0 +1,52 @@
+#ifndef _PIXIRETRO_GAME_ASSETWATCHER_H_
+#define _PIXIRETRO_GAME_ASSETWATCHER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// Watches the asset directories for files which are saved while the game runs, so assets can
+// be reloaded without restarting the game. Uses inotify; on other platforms (or if the watch
+// cannot be set up) nothing is ever reported.
+//
+// Polled from the game loop; changes are queued by the kernel between polls so nothing is
+// missed and polling never blocks.
+//
+class AssetWatcher final
+{
+public:
+
+  //
+  // The dirs (w.r.t game root dir) watched; subdirs are not watched.
+  //
+  static constexpr const char* WATCHED_PATHS[] {"assets/", "assets/levels/"};
+
+  ~AssetWatcher();
+
+  static bool initialize();
+
+  static void shutdown();
+
+  //
+  // Returns the paths (w.r.t game root dir, e.g. "assets/levels/level0.xml") of the files
+  // written or replaced since the last poll, each at most once.
+  //
+  static std::vector<std::string> poll();
+
+private:
+  static std::unique_ptr<AssetWatcher> instance;
+
+private:
+  AssetWatcher() = default;
+
+private:
+  int _fd {-1};
+
+  //
+  // Watch descriptors, in the order of WATCHED_PATHS.
+  //
+  std::vector<int> _watches;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef _PIXIRETRO_GAME_DIRTYRECTS_H_
+#define _PIXIRETRO_GAME_DIRTYRECTS_H_
+
+#include <vector>
+#include "pixiretro/pxr_rect.h"
+#include "DrawList.h"
+
+//
+// Tracks the draw commands of consecutive frames to find the parts of a screen which must
+// be redrawn when the screen is not cleared between frames.
+//
+// A command which changed (moved, changed sprite etc) dirties the rects it covered last frame
+// and covers this frame. Every command which overlaps a dirty rect must then be redrawn, and
+// since sprites are drawn whole (not clipped to the dirty rects) a redrawn command dirties
+// its own rect in turn; this repeats until no more commands are affected. The dirty rects
+// are cleared then the affected commands redrawn in draw list order.
+//
+// Commands are matched between frames by their push order, so if the number of commands
+// changes the whole screen is redrawn.
+//
+class DirtyRects
+{
+public:
+
+  DirtyRects();
+  ~DirtyRects() = default;
+
+  DirtyRects(const DirtyRects&) = default;
+  DirtyRects& operator=(const DirtyRects&) = default;
+
+  DirtyRects(DirtyRects&&) = default;
+  DirtyRects& operator=(DirtyRects&&) = default;
+
+  //
+  // Compares this frame's commands with last frame's. Returns true if the screen can be
+  // updated by clearing getClearRects and redrawing getRedraws, else false, in which case
+  // the whole screen must be cleared and redrawn.
+  //
+  bool update(const std::vector<DrawCommand>& commands);
+
+  const std::vector<pxr::iRect>& getClearRects() const {return _clearRects;}
+
+  //
+  // Element i is true if the command pushed i'th must be redrawn.
+  //
+  const std::vector<bool>& getRedraws() const {return _redraws;}
+
+  //
+  // Forces a whole screen redraw on the next update; call if anything else drew to the screen.
+  //
+  void invalidate();
+
+private:
+  void addClearRect(const pxr::iRect& rect);
+
+private:
+  std::vector<DrawCommand> _lastCommands;
+  std::vector<pxr::iRect> _clearRects;
+  std::vector<bool> _redraws;
+  bool _isInvalid;
+};
+
+#endif
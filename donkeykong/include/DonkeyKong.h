@@ -3,6 +3,7 @@
 
 #include "pixiretro/pxr_app.h"
 #include "PlayState.h"
+#include "InputReplay.h"
 
 class DonkeyKong final : public pxr::App
 {
@@ -12,6 +13,13 @@ public:
   static constexpr const char* name {"Donkey Kong 1981 Arcade"};
 
   DonkeyKong() = default;;
+
+  //
+  // Plays back (or records) the replay with 'replayName' in place of the replay element of
+  // the dkconfig; lets tools drive the whole game from a replay.
+  //
+  DonkeyKong(InputReplay::Mode replayMode, std::string replayName);
+
   ~DonkeyKong() = default;;
 
   bool onInit();
@@ -20,6 +28,10 @@ public:
   std::string getName() const {return name;}
   int getVersionMajor() const {return versionMajor;}
   int getVersionMinor() const {return versionMinor;}
+
+private:
+  InputReplay::Mode _replayMode {InputReplay::MODE_LIVE};
+  std::string _replayName;
 };
 
 #endif
@@ -0,0 +1,115 @@
+#ifndef _PIXIRETRO_GAME_DRAWLIST_H_
+#define _PIXIRETRO_GAME_DRAWLIST_H_
+
+#include <vector>
+#include <cstdint>
+#include "pixiretro/pxr_gfx.h"
+#include "pixiretro/pxr_vec.h"
+#include "pixiretro/pxr_rect.h"
+#include "RenderBuffer.h"
+
+//
+// A sprite draw deferred until the draw list is submitted.
+//
+struct DrawCommand
+{
+  int _layer;
+  pxr::gfx::ResourceKey_t _spritesheetKey;
+  pxr::gfx::SpriteId_t _spriteid;
+  pxr::Vector2i _position;
+  bool _mirrorX;
+  bool _mirrorY;
+
+  //
+  // The screen space rect covered by the sprite.
+  //
+  pxr::iRect _bounds;
+};
+
+bool operator==(const DrawCommand& a, const DrawCommand& b);
+bool operator!=(const DrawCommand& a, const DrawCommand& b);
+
+//
+// Collects the sprite draws of a frame so they can be submitted in one ordered pass. Draws
+// are ordered by layer (ascending, so higher layers are drawn on top) and within a layer
+// grouped by spritesheet, so the draws of each spritesheet are submitted as a contiguous
+// run. Draws with equal layer and spritesheet keep the order they were pushed in.
+//
+class DrawList
+{
+public:
+
+  //
+  // The supported range of layers.
+  //
+  static constexpr int bottomLayer {-32768};
+  static constexpr int topLayer {32767};
+
+  DrawList();
+  ~DrawList() = default;
+
+  DrawList(const DrawList&) = delete;
+  DrawList& operator=(const DrawList&) = delete;
+
+  DrawList(DrawList&&) = default;
+  DrawList& operator=(DrawList&&) = default;
+
+  //
+  // Clears the commands and the culled count; the cull rect is kept.
+  //
+  void clear();
+
+  //
+  // Commands whose bounds do not intersect the cull rect are discarded by push. By default
+  // nothing is culled.
+  //
+  void setCullRect(const pxr::iRect& rect);
+  void disableCulling();
+
+  void push(const DrawCommand& command);
+
+  //
+  // Sorts the list and appends a sprite draw for every command to the render buffer. The
+  // list is not cleared.
+  //
+  void submit(RenderBuffer& renderBuffer, int screenid);
+
+  //
+  // As submit but draws only the commands for which isSelected[i] is true, where i is the
+  // order in which the command was pushed.
+  //
+  void submit(RenderBuffer& renderBuffer, int screenid, const std::vector<bool>& isSelected);
+
+  //
+  // The commands in the order they were pushed.
+  //
+  const std::vector<DrawCommand>& getCommands() const {return _commands;}
+
+  int getCommandCount() const {return _commands.size();}
+
+  //
+  // The number of commands discarded by push since the last clear.
+  //
+  int getCulledCount() const {return _culledCount;}
+
+  //
+  // The number of contiguous runs of the same spritesheet in the last submit.
+  //
+  int getRunCount() const {return _runCount;}
+
+private:
+  std::vector<DrawCommand> _commands;
+
+  //
+  // Per command sort keys; layer in the high bits, then spritesheet, then push order.
+  //
+  std::vector<uint64_t> _sortKeys;
+
+  int _runCount;
+
+  pxr::iRect _cullRect;
+  bool _isCulling;
+  int _culledCount;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef _PIXIRETRO_GAME_INPUT_REPLAY_H_
+#define _PIXIRETRO_GAME_INPUT_REPLAY_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include "pixiretro/pxr_input.h"
+
+//
+// Singleton class which records the per-tick state of a set of keys (and the tick dt) to a
+// replay file, or plays one back in place of live input. Game code reads keys through
+// InputReplay::isKeyDown/isKeyPressed rather than pxr::input so playback is transparent.
+//
+// If not initialized (or initialized in MODE_LIVE) all calls forward to pxr::input. Keys not
+// in the recorded set are always read live, in every mode.
+//
+// Recording seeds the game's Random generator with a fresh seed and stores it in the header;
+// playback reseeds with the stored seed so random frames and prop states repeat too.
+//
+// File format (little endian):
+//
+//    header : char[4] magic "DKRP", uint8 version, uint8 keyCount, int32 keyCodes[keyCount],
+//             uint64 randomSeed
+//    ticks  : a packed record per tick, (2 * keyCount) + 1 bits rounded up to whole bytes;
+//             bit k is key k down, bit keyCount + k is key k pressed, bit 2 * keyCount is
+//             set if the dt changed, in which case the record is followed by a float32 dt.
+//
+class InputReplay final
+{
+public:
+
+  enum Mode
+  {
+    MODE_LIVE,
+    MODE_RECORD,
+    MODE_PLAYBACK
+  };
+
+  //
+  // The dir (w.r.t game root dir) in which replay files are stored.
+  //
+  static constexpr const char* RESOURCE_PATH_REPLAYS {"replays/"};
+  static constexpr const char* REPLAY_FILE_EXTENSION {".dkr"};
+
+  static constexpr int maxKeyCount {16};
+
+  ~InputReplay() = default;
+
+  //
+  // Opens the replay with 'name' for recording or playback of 'keys'. In playback mode the
+  // file must have been recorded with the same keys in the same order. Returns true on
+  // success else false; errors are logged. Does nothing in MODE_LIVE.
+  //
+  static bool initialize(Mode mode, const std::string& name, const std::vector<pxr::input::KeyCode>& keys);
+
+  //
+  // Flushes and closes the replay file.
+  //
+  static void shutdown();
+
+  //
+  // Call at the start of every tick, before any keys are read. Returns the dt to use for the
+  // tick; when playing back this is the recorded dt rather than 'dt'.
+  //
+  static float onTick(float dt);
+
+  static bool isKeyDown(pxr::input::KeyCode key);
+  static bool isKeyPressed(pxr::input::KeyCode key);
+
+  static Mode getMode();
+
+  //
+  // True once all recorded ticks have been played back.
+  //
+  static bool isPlaybackOver();
+
+private:
+  static std::unique_ptr<InputReplay> instance;
+
+private:
+  InputReplay() = default;
+
+  bool openForRecord(const std::string& path);
+  bool openForPlayback(const std::string& path);
+
+  void recordTick(float dt);
+  bool playbackTick(float& dt);
+
+  int findKey(pxr::input::KeyCode key) const;
+
+  int getBytesPerTick() const;
+
+private:
+  Mode _mode;
+  std::vector<pxr::input::KeyCode> _keys;
+  std::fstream _file;
+  std::string _path;
+
+  //
+  // The state of the keys in the current tick; bit k of each is key k.
+  //
+  uint32_t _keysDown;
+  uint32_t _keysPressed;
+
+  float _lastDt;
+  bool _isPlaybackOver;
+};
+
+#endif
@@ -2,9 +2,16 @@
 #define _PIXIRETRO_GAME_LEVEL_H_
 
 #include <memory>
+#include <string>
 #include <vector>
+#include "pixiretro/pxr_log.h"
 #include "ControlScheme.h"
 #include "Prop.h"
+#include "PropGrid.h"
+#include "PropHotData.h"
+#include "DrawList.h"
+#include "RenderBuffer.h"
+#include "DirtyRects.h"
 #include "Mario.h"
 
 class PlayState;
@@ -33,8 +40,49 @@ public:
     ENDING_WIN
   };
 
+  //
+  // In full mode the caller clears the screen each frame and the level draws everything. In
+  // dirty rects mode the caller must not clear the screen; the level clears and redraws only
+  // the parts of the screen which changed since the last frame.
+  //
+  enum RenderMode
+  {
+    RENDER_FULL,
+    RENDER_DIRTY_RECTS
+  };
+
   static constexpr const char* RESOURCE_PATH_LEVEL {"assets/levels/"};
 
+  //
+  // A prop of a level layout. Refers to its definition by prop factory handle; names are
+  // resolved when the level file is parsed, so building a level looks up no strings.
+  //
+  struct PropPlacement
+  {
+    int _definition;
+    pxr::Vector2f _position;
+  };
+
+  //
+  // The contents of a level file; what a level is built from.
+  //
+  struct Layout
+  {
+    pxr::Vector2f _marioSpawnPosition;
+    std::vector<PropPlacement> _props;
+  };
+
+  //
+  // A message of a parse made off the main thread, held for the main thread to log since the
+  // engine's log is not thread safe.
+  //
+  struct LogMessage
+  {
+    pxr::log::Level _level;
+    const char* _msg;
+    std::string _addendum;
+  };
+
   Level();
   ~Level() = default;
 
@@ -50,6 +98,27 @@ public:
   //
   bool load(const std::string& file);
 
+  //
+  // The two halves of load. Parsing reads the level file (or asset pack). It logs, unless
+  // 'messages' is given, in which case they are appended to it instead; parsing makes no
+  // other engine calls, so with a buffer may be called from any thread (while the asset pack
+  // and prop definitions are not changing). Building makes the props of the layout; it does
+  // no logging and makes no engine calls so may be called from any thread (once the
+  // factories are initialized). Build requires the level is unloaded.
+  //
+  static bool parse(const std::string& file, Layout* layout, std::vector<LogMessage>* messages = nullptr);
+
+  //
+  // Parses the level file even if the asset pack has the level; for reloading edited files.
+  //
+  static bool parseXml(const std::string& file, Layout* layout, std::vector<LogMessage>* messages = nullptr);
+  void build(const Layout& layout);
+
+  //
+  // Logs the messages of a buffered parse; main thread only.
+  //
+  static void logMessages(const std::vector<LogMessage>& messages);
+
   //
   // Clears the level into a state ready to load another level, will also
   // require reinitializing. Allows a level instance to be reused.
@@ -57,19 +126,55 @@ public:
   void unload();
 
   //
-  // Call post load to setup the level.
+  // Stops a level which has been initialized and returns it to its post load state, so it
+  // can be initialized (and played from the start) again without reloading.
   //
-  void onInit(std::shared_ptr<const ControlScheme> controlScheme);
+  void suspend();
+
+  //
+  // Call post load to setup the level. Static props are drawn once to the background screen,
+  // which should be drawn beneath the screen passed to onDraw and must not be cleared by the
+  // caller. If backgroundScreenid is negative all props are drawn every frame.
+  //
+  void onInit(std::shared_ptr<const ControlScheme> controlScheme, int backgroundScreenid);
 
   void onUpdate(double now, float dt);
 
-  void onDraw(int screenid);
+  void onDraw(RenderBuffer& renderBuffer, int screenid);
+
+  //
+  // Props (and mario) whose sprites lie entirely outside the viewport are not drawn. The
+  // viewport is in world space; defaults to the whole world.
+  //
+  void setViewport(const pxr::iRect& viewport);
+
+  void setRenderMode(RenderMode mode);
+  RenderMode getRenderMode() const;
+
+  //
+  // The font the debug draw stats are drawn with; owned by the caller, who must keep it
+  // loaded while the level uses it. The stats are not drawn without one.
+  //
+  void setDebugFont(pxr::gfx::ResourceKey_t fontKey);
+
+  //
+  // In dirty rects mode, forces the next draw to redraw the whole screen. Call after drawing
+  // anything else to the screen.
+  //
+  void invalidateScreen();
 
   //
   // Resets the level to its 'fresh' post load and initialize state.
   //
   void reset();
 
+  //
+  // Call after the prop factory reloads its definitions. Props re-enter their current state
+  // to pick up the changes, and are rebinned and reclassified for drawing in place; they are
+  // only reindexed if a draw layer change reordered them.
+  //
+  void onPropDefinitionsChanged();
+
   bool isOver();
   Ending getEnding();
 
@@ -89,7 +194,43 @@ private:
   void updatePlaying(double now, float dt);
   void updateExitCutscene(double now, float dt);
 
-  void debugDraw(int screenid);
+  void debugDraw(RenderBuffer& renderBuffer, int screenid);
+
+  static bool parsePacked(int packIndex, Layout* layout, std::vector<LogMessage>* messages);
+
+  //
+  // Sorts the loaded props and builds the per-prop level data; the common tail of loads.
+  //
+  void onPropsLoaded();
+
+  //
+  // Sorts the props by draw layer and builds their hot data, grid bins and draw classes.
+  //
+  void indexProps();
+
+  //
+  // Splits the props into background and foreground props.
+  //
+  void classifyProps();
+
+  //
+  // Returns all props to their initial state and rebins the moving props.
+  //
+  void resetProps();
+
+  //
+  // Captures the state of the props as initialized, and returns them to it. Restoring is a
+  // copy of plain data per prop and of the hot data arrays; unlike resetProps it does not
+  // look up animations or replay sounds, so a reset costs little whatever the level size.
+  // If there is no snapshot (e.g. after a reload) restoring resets the props and captures.
+  //
+  void captureProps();
+  void restoreProps();
+
+  void drawBackground(RenderBuffer& renderBuffer);
+  void submitDirtyRects(RenderBuffer& renderBuffer, int screenid);
+
+  pxr::AABB getHotInteractionBox(int propIndex) const;
 
   void startMusic();
   void stopMusic();
@@ -103,11 +244,63 @@ private:
 
   std::vector<Prop> _props;
 
+  //
+  // Hot per-prop data kept in sync by the props themselves; element i belongs to _props[i].
+  // Heap allocated so the address the props are bound to survives moves of the level.
+  //
+  std::unique_ptr<PropHotData> _propHotData;
+
+  //
+  // The props and their hot data as they were at the end of onInit; level resets restore
+  // them.
+  //
+  std::vector<Prop::Snapshot> _propSnapshots;
+  PropHotData _propHotDataSnapshot;
+
+  //
+  // Broadphase for prop interactions. Static props are binned once upon load, only the
+  // props in _movingProps (indices into _props) are rebinned during play.
+  //
+  PropGrid _propGrid;
+  std::vector<int> _movingProps;
+
+  //
+  // Per tick scratch buffers; the props in cells near mario, and those which intersect him.
+  //
+  std::vector<int> _propCandidates;
+  std::vector<int> _propHits;
+
   pxr::Vector2f _marioSpawnPosition;
   std::unique_ptr<Mario> _mario;
 
   std::vector<const Prop*> _propInteractions;
 
+  //
+  // Rebuilt every frame from the props and mario.
+  //
+  DrawList _drawList;
+
+  //
+  // Indices into _props. Background props never change appearance and are drawn below all
+  // foreground props; they are the static draw props with a layer no higher than the lowest
+  // layer of any non static draw prop (so caching them cannot change the draw order).
+  //
+  std::vector<int> _backgroundProps;
+  std::vector<int> _foregroundProps;
+  int _backgroundScreenid;
+  bool _isBackgroundDirty;
+
+  RenderMode _renderMode;
+  DirtyRects _dirtyRects;
+
+  //
+  // Draw stats of the last frame (excluding background props) shown by the debug draw.
+  //
+  int _drawnCount;
+  int _culledCount;
+
+  pxr::gfx::ResourceKey_t _debugFontKey;
+
   bool _isMusicPlaying;
   bool _isDebugDraw;
 };
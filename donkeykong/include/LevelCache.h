@@ -0,0 +1,117 @@
+#ifndef _PIXIRETRO_GAME_LEVELCACHE_H_
+#define _PIXIRETRO_GAME_LEVELCACHE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Level.h"
+
+//
+// Keeps loaded levels ready to play, so changing level does not stall the game thread on a
+// load. Levels are preloaded on a loader thread and recently played levels are kept, both
+// in a least recently used cache of a fixed number of levels.
+//
+// Preloads are parsed and built on the loader thread. The engine's log is not thread safe,
+// so the messages of the parse are buffered and logged on the game thread when the built
+// level is collected.
+//
+// Cached levels are loaded but uninitialized; call onInit on a taken level before playing
+// it, and suspend a played level before giving it back.
+//
+class LevelCache
+{
+public:
+  static constexpr int defaultCapacity {4};
+
+  explicit LevelCache(int capacity = defaultCapacity);
+  ~LevelCache();
+
+  LevelCache(const LevelCache&) = delete;
+  LevelCache& operator=(const LevelCache&) = delete;
+
+  //
+  // Starts loading the level on the loader thread unless it is cached or already being
+  // loaded. A level which fails to load is logged when collected and is not cached.
+  //
+  void preload(const std::string& name);
+
+  //
+  // Takes a level out of the cache, waiting for it if it is being built and loading it on
+  // the calling thread if it was never preloaded. Returns nullptr if the level cannot be
+  // loaded.
+  //
+  std::unique_ptr<Level> take(const std::string& name);
+
+  //
+  // Returns a suspended level to the cache as the most recently used.
+  //
+  void give(const std::string& name, std::unique_ptr<Level> level);
+
+  //
+  // Waits for the loader thread to finish the level it is building, discards any queued
+  // preloads and stops the thread. Must be called before the factories shut down.
+  //
+  void stop();
+
+  //
+  // Stops the loader thread and discards every cached level; call before changing anything
+  // levels are built from (e.g. reloading definitions).
+  //
+  void clear();
+
+private:
+  struct Entry
+  {
+    std::string _name;
+    std::unique_ptr<Level> _level;
+  };
+
+  //
+  // A level loaded by the loader thread, with the messages of its parse; _level is nullptr
+  // if the load failed.
+  //
+  struct Built
+  {
+    std::string _name;
+    std::unique_ptr<Level> _level;
+    std::vector<Level::LogMessage> _messages;
+  };
+
+  void run();
+
+  //
+  // Logs the messages of built levels and moves them into the cache; game thread only.
+  //
+  void collectBuilt();
+
+  void insert(Entry entry);
+
+  //
+  // Is the level queued or being built; the mutex must be held.
+  //
+  bool isPending(const std::string& name) const;
+
+private:
+  int _capacity;
+
+  //
+  // Most recently used first; only accessed by the game thread.
+  //
+  std::list<Entry> _levels;
+
+  std::thread _thread;
+  std::mutex _mutex;
+  std::condition_variable _jobCondition;
+  std::condition_variable _builtCondition;
+  std::deque<std::string> _jobs;
+  std::string _building;
+  std::vector<Built> _built;
+  bool _isStopping;
+};
+
+#endif
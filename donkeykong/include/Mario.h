@@ -20,6 +20,11 @@ class Mario
 
 public:
 
+  //
+  // Mario is drawn on top of all props.
+  //
+  static constexpr int drawLayer {DrawList::topLayer};
+
   enum State
   {
     STATE_DEAD = -1,
@@ -41,6 +46,7 @@ public:
   {
 
     Definition(std::array<std::string, Mario::STATE_COUNT> animationNames,
+               std::array<int, Mario::STATE_COUNT> animationHandles,
                std::array<std::pair<pxr::sfx::ResourceKey_t, bool>, Mario::STATE_COUNT> sounds,
                pxr::Vector2i size,
                pxr::fRect propInteractionBox,
@@ -60,6 +66,12 @@ public:
     //
     std::array<std::string, STATE_COUNT> _animationNames;
 
+    //
+    // The animation factory handles of the animations, resolved by the loader (which rejects
+    // unknown names).
+    //
+    std::array<int, STATE_COUNT> _animationHandles;
+
     //
     // Sounds to play on state entry (zero or one for each state). If a state has zero
     // sounds to play then the resource key == -1. The assiciated bool is a loop flag which
@@ -121,7 +133,7 @@ public:
 
   void onInput();
   void onUpdate(double now, float dt);
-  void onDraw(int screenid);
+  void onDraw(DrawList& drawList);
 
   void onPropInteractions(const std::vector<const Prop*>& props);
   //void onBarrelCollisions(const std::vector<Barrel>& barrels);
@@ -153,6 +165,14 @@ public:
   //
   pxr::gfx::SpriteId_t getSpriteId() const;
 
+  //
+  // Returns the opacity mask of the sprite currently being drawn to represent mario, and how
+  // that sprite is mirrored when drawn.
+  //
+  const SpriteMask& getSpriteMask() const;
+  bool isMirroringX() const;
+  bool isMirroringY() const;
+
 private:
 
   //
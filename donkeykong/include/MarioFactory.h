@@ -2,6 +2,8 @@
 #define _PIXIRETRO_GAME_MARIO_FACTORY_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 #include "Mario.h"
 
 class MarioFactory
@@ -15,6 +17,13 @@ public:
 
   static void shutdown();
 
+  //
+  // Reloads the mario definition file, keeping the current definition if it fails to load.
+  // The definition is patched in place so existing marios see the change; animations change
+  // on their next state change.
+  //
+  static bool reload();
+
   static Mario makeMario(pxr::Vector2f spawnPosition, std::shared_ptr<const ControlScheme> controlScheme);
 
 private:
@@ -27,8 +36,15 @@ private:
 
   bool loadMarioDefinition();
 
+  //
+  // Acquires a sound from the resource cache, recording the name to release it on shutdown.
+  //
+  pxr::sfx::ResourceKey_t acquireSound(const char* soundName);
+
 private:
   std::shared_ptr<Mario::Definition> _marioDefinition;
+
+  std::vector<std::string> _soundNames;
 };
 
 
@@ -6,14 +6,20 @@
 #include "pixiretro/pxr_app.h"
 #include "pixiretro/pxr_input.h"
 #include "Level.h"
+#include "LevelCache.h"
 #include "ControlScheme.h"
+#include "InputReplay.h"
+#include "RenderBuffer.h"
 
 class PlayState final : public pxr::AppState
 {
 public:
   static constexpr const char* name {"play"};
 
-  PlayState(pxr::App* owner);
+  //
+  // A replay mode other than MODE_LIVE overrides the replay element of the dkconfig.
+  //
+  PlayState(pxr::App* owner, InputReplay::Mode replayMode, std::string replayName);
   ~PlayState() = default;
 
   bool onInit();
@@ -21,6 +27,11 @@ public:
   void onDraw(double now, float dt, int screenid);
   void onReset();
 
+  //
+  // Stops preloading levels; must be called before the factories are shut down.
+  //
+  void onShutdown();
+
   std::string getName() const {return name;}
 
 private:
@@ -30,13 +41,44 @@ private:
 
   static constexpr pxr::input::KeyCode nextLevelCheatKey {pxr::input::KEY_m};
   static constexpr pxr::input::KeyCode prevLevelCheatKey {pxr::input::KEY_n};
+  static constexpr pxr::input::KeyCode profilerOverlayToggleKey {pxr::input::KEY_x};
+
+  static constexpr const char* debugFontName {"dogica8"};
 
   void onCheatInput();
   bool nextLevel(bool loop);
   bool prevLevel(bool loop);
+
+  //
+  // Swaps the current level for the level at 'levelIndex', returning the current level to
+  // the level cache, then preloads the level after it. If the level cannot be loaded the
+  // current level is kept and false returned.
+  //
+  bool changeLevel(int levelIndex);
+  void preloadNextLevel();
+
+  //
+  // Reloads the assets saved since the last tick; only called if hot reloading is enabled.
+  //
+  void onAssetChanges();
+  void reloadLevel(const std::string& levelName);
+
+  //
+  // Once a packed source has been edited the pack is stale, so every later load (of any
+  // level) must come from the xml.
+  //
+  void closeAssetPack();
+
   void handleLevelWin();
   void handleLevelLoss();
 
+  //
+  // Exits the game through the app's onShutdown, so the reports are logged, the trace is
+  // flushed and the loader thread is stopped; the engine has no way for a state to end its
+  // loop.
+  //
+  [[noreturn]] void quit(int status);
+
   bool loadDKConfig();
 
 private:
@@ -46,13 +88,49 @@ private:
   //
   std::vector<std::string> _levelNames;
   int _currentLevel;
-  Level _level;
+  std::unique_ptr<Level> _level;
+
+  //
+  // The next level is preloaded while the current one plays; recently played levels are
+  // kept so cycling between them (via the cheat keys) is instant.
+  //
+  LevelCache _levelCache;
 
   std::shared_ptr<ControlScheme> _controlScheme;
 
+  //
+  // The level draws its static props to this screen once; must be created before the
+  // app's screen so it is drawn beneath it.
+  //
+  int _backgroundScreenid;
+
+  Level::RenderMode _renderMode;
+
+  //
+  // Loaded once and shared by every level, cached or not, for their debug draw.
+  //
+  pxr::gfx::ResourceKey_t _debugFontKey;
+
+  //
+  // The draws of a frame are recorded here and executed at the end of onDraw.
+  //
+  RenderBuffer _renderBuffer;
+
   int _marioLives;
   int _score;
   bool _isCheating; // TODO load this from the dkconfig
+  bool _isProfilerOverlay;
+
+  //
+  // Set by the optional hotReload element of the dkconfig; reload assets when they are saved.
+  //
+  bool _isHotReloading;
+
+  //
+  // Set by the constructor or else by the optional replay element of the dkconfig.
+  //
+  InputReplay::Mode _replayMode;
+  std::string _replayName;
 };
 
 #endif
@@ -0,0 +1,156 @@
+#ifndef _PIXIRETRO_GAME_PROFILER_H_
+#define _PIXIRETRO_GAME_PROFILER_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "RenderBuffer.h"
+
+//
+// Measures the wall time spent in the phases of a frame. Each phase is timed between calls
+// to beginPhase and endPhase (or the lifetime of a ScopedPhase); a phase may be entered many
+// times per frame, the times sum. Call endFrame once per frame to commit the frame.
+//
+// The last frameCapacity frames are kept in a ring buffer, which the overlay draws as a
+// stacked bar graph (one column per frame). Session wide stats (min/avg/p99 per phase) are
+// kept in per-phase histograms and logged by logReport.
+//
+// The ring buffer has a single writer (the thread calling endFrame); readers on other
+// threads may read it without locks via getFrameCount and getFrame. Each slot is guarded by
+// a sequence counter (a seqlock), so a read which overlaps the writer reusing the slot is
+// detected and fails rather than returning a torn frame.
+//
+class Profiler final
+{
+public:
+
+  enum Phase
+  {
+    PHASE_UPDATE,        // the whole game state update, contains the level phases below.
+    PHASE_PROP_UPDATE,   // updating props and rebinning those which move.
+    PHASE_INTERACTION,   // scanning for props which intersect mario.
+    PHASE_PIXEL_TESTS,   // pixel testing mario against the killer props he intersects.
+    PHASE_MARIO,         // mario input and update.
+    PHASE_DRAW,          // drawing the level.
+    PHASE_COUNT
+  };
+
+  static constexpr int frameCapacity {256};
+
+  //
+  // Width of a histogram bucket and number of buckets; times beyond the last bucket are
+  // counted in the last bucket.
+  //
+  static constexpr int64_t histogramBucketNanoseconds {20'000};
+  static constexpr int histogramBucketCount {2'500};
+
+  //
+  // The frame time budget drawn as a line across the overlay; 20ms at fpsLock=50.
+  //
+  static constexpr int64_t frameBudgetNanoseconds {20'000'000};
+
+  struct PhaseStats
+  {
+    int64_t _totalNanoseconds;
+    int64_t _sampleCount;
+  };
+
+  struct Frame
+  {
+    std::array<int64_t, PHASE_COUNT> _phaseNanoseconds;
+  };
+
+  //
+  // Times a phase for the lifetime of the instance.
+  //
+  class ScopedPhase
+  {
+  public:
+    explicit ScopedPhase(Phase phase) : _phase{phase} {Profiler::beginPhase(_phase);}
+    ~ScopedPhase() {Profiler::endPhase(_phase);}
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+  private:
+    Phase _phase;
+  };
+
+  static void beginPhase(Phase phase);
+  static void endPhase(Phase phase);
+
+  //
+  // Commits the current frame to the ring buffer and histograms, and starts a new frame.
+  //
+  static void endFrame();
+
+  //
+  // Totals over all phase entries since the last clear.
+  //
+  static const PhaseStats& getPhaseStats(Phase phase);
+  static const char* getPhaseName(Phase phase);
+
+  //
+  // The number of frames committed since the last clear; frames [count - frameCapacity,
+  // count) are available via getFrame, frame count - 1 being the latest.
+  //
+  static uint64_t getFrameCount();
+
+  //
+  // Copies frame 'frameNo' into 'frame'. Returns false if the frame has not been committed or
+  // has since been overwritten (including while it was being copied).
+  //
+  static bool getFrame(uint64_t frameNo, Frame* frame);
+
+  //
+  // Zeros all stats, frames and histograms. Not safe while another thread reads frames.
+  //
+  static void clear();
+
+  //
+  // Draws the ring buffer as a stacked bar graph of the level phases, with the frame budget
+  // as a line. The graph is anchored to the bottom-left of the screen.
+  //
+  static void drawOverlay(RenderBuffer& renderBuffer, int screenid);
+
+  //
+  // Logs the min/avg/p99 frame time of each phase over all frames since the last clear.
+  //
+  static void logReport();
+
+private:
+  using Clock_t = std::chrono::steady_clock;
+
+  struct Histogram
+  {
+    std::array<int64_t, histogramBucketCount> _buckets;
+    int64_t _minNanoseconds;
+    int64_t _totalNanoseconds;
+    int64_t _frameCount;
+  };
+
+  //
+  // A ring buffer slot. The sequence is odd while the slot is being written and advances by
+  // two per write, so after w writes it is 2w; the phase times are atomics only so readers
+  // racing the writer are well defined, the sequence decides if what they read is valid.
+  //
+  struct Slot
+  {
+    std::atomic<uint64_t> _sequence;
+    std::array<std::atomic<int64_t>, PHASE_COUNT> _phaseNanoseconds;
+  };
+
+  Profiler() = delete;
+
+  static std::array<Clock_t::time_point, PHASE_COUNT> phaseStarts;
+  static std::array<PhaseStats, PHASE_COUNT> phaseStats;
+
+  static Frame currentFrame;
+  static std::array<Slot, frameCapacity> slots;
+  static std::atomic<uint64_t> frameCount;
+
+  static std::array<Histogram, PHASE_COUNT> histograms;
+};
+
+#endif
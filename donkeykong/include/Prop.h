@@ -11,6 +11,7 @@
 #include "pixiretro/pxr_log.h"
 #include "Transition.h"
 #include "Animation.h"
+#include "PropHotData.h"
 
 class Prop
 {
@@ -34,13 +35,35 @@ public:
   //
   // Draw the prop to a screen.
   //
-  void onDraw(int screenid);
+  void onDraw(DrawList& drawList);
 
   //
   // Resets the prop to its initial state when first constructed.
   //
   void reset();
 
+  //
+  // The mutable state of a prop, excluding its hot data (which the level snapshots as a
+  // whole). Restoring a snapshot returns the prop to the state it was captured in without
+  // replaying state entry sounds.
+  //
+  struct Snapshot
+  {
+    int _currentState;
+    float _stateClock;
+    Animation::Snapshot _animation;
+    Transition::Snapshot _transition;
+  };
+
+  Snapshot getSnapshot() const;
+  void restore(const Snapshot& snapshot);
+
+  //
+  // Call after the prop's definition is patched by a reload; re-enters the current state (or
+  // the first if the state no longer exists) to pick up the new state data.
+  //
+  void redefine();
+
   //
   // Returns knowledge of what effects this prop has on actors.
   //
@@ -49,6 +72,18 @@ public:
   bool isConveyor() const;
   bool isKiller() const;
 
+  //
+  // Returns true if the interaction box of this prop can never change, i.e. the prop has
+  // a single state which does not move.
+  //
+  bool isStatic() const {return _isStatic;}
+
+  //
+  // Returns true if the prop always looks the same, i.e. it is static and its animation
+  // never changes frame, so it can be drawn once and cached.
+  //
+  bool isStaticDraw() const {return _isStatic && _animation.isStatic();}
+
   //
   // Returns the y-axis position w.r.t world space which this prop will support actors at,
   // i.e. actors standing on this support stand at this height.
@@ -99,6 +134,21 @@ public:
   //
   pxr::gfx::SpriteId_t getSpriteId() const;
 
+  //
+  // The opacity mask of the sprite currently being used to represent the prop, and how
+  // that sprite is mirrored when drawn.
+  //
+  const SpriteMask& getSpriteMask() const;
+  bool isMirroringX() const;
+  bool isMirroringY() const;
+
+  //
+  // Binds the prop to an element of the owning level's hot data arrays. From then on the prop
+  // keeps that element in sync with its own state. The hot data must outlive the prop (or
+  // the prop must be rebound).
+  //
+  void bindHotData(PropHotData* hotData, int hotIndex);
+
 private:
 
   //
@@ -131,6 +181,7 @@ private:
                     std::vector<pxr::sfx::ResourceKey_t>                  sounds,
                     pxr::fRect                                            interactionBox,
                     std::string                                           animationName,
+                    int                                                   animationHandle,
                     float                                                 duration,
                     float                                                 supportHeight,
                     float                                                 ladderHeight,
@@ -176,6 +227,12 @@ private:
     //
     std::string _animationName; 
 
+    //
+    // The animation factory handle of _animationName, resolved by the loader (which rejects
+    // unknown names) so entering a state does not look the animation up by name.
+    //
+    int _animationHandle;
+
     //
     // How long this prop states persists before transitioning to the next.
     //
@@ -258,7 +315,15 @@ private:
   //
   Prop(pxr::Vector2f position, std::shared_ptr<const Definition> def);
 
-  void transitionToState(int state);
+  void updateState(float dt);
+
+  //
+  // Props are constructed without playing the entry sounds of their initial state, so that
+  // they can be constructed off the main thread; reset plays them.
+  //
+  void transitionToState(int state, bool isPlayingSounds = true);
+
+  void syncHotData();
 
 private:
 
@@ -300,6 +365,17 @@ private:
   // Optimisation flag to disable state changes for props which have only a single state.
   //
   bool _isChangingStates;
+
+  //
+  // Optimisation flag to skip tracking the interaction box of props which never move.
+  //
+  bool _isStatic;
+
+  //
+  // The hot data element this prop writes to, or nullptr if unbound.
+  //
+  PropHotData* _hotData;
+  int _hotIndex;
 };
 
 #endif
@@ -2,6 +2,7 @@
 #define _PIXIRETRO_GAME_PROPFACTORY_H_
 
 #include <unordered_map>
+#include <vector>
 #include "Prop.h"
 
 class PropFactory final
@@ -32,9 +33,24 @@ public:
   static void shutdown();
 
   //
+  // Reloads the prop definitions file (never the asset pack), keeping the current definitions
+  // if it fails to load. Definitions are patched in place, so existing props see the change;
+  // they must be redefined (see Prop::redefine) before they next update.
   //
+  static bool reload();
+
+  //
+  // Returns the handle of the prop definition with name 'propName', or -1 if there is no such
+  // definition. Handles are dense indices assigned at load and are stable across reloads. If
+  // the definitions were loaded from the asset pack a definition's handle is its index in the
+  // pack. Does not log, so may be called from the level loader thread.
   //
-  static Prop makeProp(pxr::Vector2f position, const std::string& propName);
+  static int findDefinition(const std::string& propName);
+
+  //
+  // Makes a prop from the definition with 'handle'; no strings are looked up.
+  //
+  static Prop makeProp(pxr::Vector2f position, int handle);
 
 private:
 
@@ -45,9 +61,27 @@ private:
   PropFactory() = default;
 
   bool loadPropDefinitions();
+  bool loadPackedPropDefinitions();
+
+  //
+  // Acquires a sound from the resource cache on first use; states share the keys of their
+  // sounds.
+  //
+  pxr::sfx::ResourceKey_t loadSound(const char* soundName);
+
+  //
+  // Assigns the next handle to a definition; a name already defined keeps its definition.
+  //
+  void addDefinition(const std::string& propName, std::shared_ptr<Prop::Definition> def);
 
 private:
-  std::unordered_map<std::string, std::shared_ptr<Prop::Definition>> _defs;
+  //
+  // The definitions by handle, in load (and so asset pack) order.
+  //
+  std::unordered_map<std::string, int> _handles;
+  std::vector<std::shared_ptr<Prop::Definition>> _defs;
+
+  std::unordered_map<std::string, pxr::sfx::ResourceKey_t> _soundKeys;
 };
 
 
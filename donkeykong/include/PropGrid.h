@@ -0,0 +1,108 @@
+#ifndef _PIXIRETRO_GAME_PROPGRID_H_
+#define _PIXIRETRO_GAME_PROPGRID_H_
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include "pixiretro/pxr_collision.h"
+#include "Defines.h"
+
+//
+// A uniform grid over world space which bins props by their interaction boxes. Used as a
+// broadphase to limit interaction tests to only those props near an actor.
+//
+//    y
+//    ^
+//    |---+---+---+---+
+//    |   |   | b | b |        Each prop is stored in every cell its interaction box
+//    |---+---+---+---+        overlaps. A query returns all props stored in the cells
+//    | a |   | b | b |        the query box overlaps.
+//    |---+---+---+---+
+//    | a |   |   |   |        Boxes which extend beyond the world are clamped into the
+//    o---+---+---+---+--> x   border cells, thus props placed off screen still bin.
+//
+// Props are identified by their index; the grid does not reference props directly.
+//
+class PropGrid
+{
+public:
+
+  //
+  // Size of each (square) cell in pixels.
+  //
+  static constexpr int cellSize {16};
+
+  static constexpr int columnCount {(worldSize._x + cellSize - 1) / cellSize};
+  static constexpr int rowCount {(worldSize._y + cellSize - 1) / cellSize};
+
+  PropGrid();
+  ~PropGrid() = default;
+
+  PropGrid(const PropGrid&) = delete;
+  PropGrid& operator=(const PropGrid&) = delete;
+
+  PropGrid(PropGrid&&) = default;
+  PropGrid& operator=(PropGrid&&) = default;
+
+  //
+  // Removes all props from the grid.
+  //
+  void clear();
+
+  //
+  // Adds a prop to the grid. Prop indices must be inserted in the order 0, 1, 2 ... N.
+  //
+  void insert(int propIndex, const pxr::AABB& box);
+
+  //
+  // Updates the cells of a previously inserted prop. The prop is only rebinned if the
+  // set of cells its box overlaps has changed, thus a moving prop costs nothing until it
+  // crosses a cell boundary.
+  //
+  void update(int propIndex, const pxr::AABB& box);
+
+  //
+  // Writes the indices of all props in the cells the query box overlaps to 'propIndices'
+  // (overwriting its contents). Results are unique and in ascending order of index.
+  //
+  void query(const pxr::AABB& box, std::vector<int>& propIndices);
+
+private:
+
+  //
+  // The inclusive range of cells a box overlaps.
+  //
+  struct CellSpan
+  {
+    int _colMin;
+    int _colMax;
+    int _rowMin;
+    int _rowMax;
+
+    bool operator==(const CellSpan& other) const;
+    bool operator!=(const CellSpan& other) const {return !(*this == other);}
+  };
+
+  CellSpan computeSpan(const pxr::AABB& box) const;
+
+  void addToCells(int propIndex, const CellSpan& span);
+  void removeFromCells(int propIndex, const CellSpan& span);
+
+private:
+
+  std::array<std::vector<int>, columnCount * rowCount> _cells;
+
+  //
+  // The cells currently occupied by each prop, indexed by prop index.
+  //
+  std::vector<CellSpan> _spans;
+
+  //
+  // Used to reject duplicates during queries for props which span multiple cells; a prop
+  // is a duplicate if its stamp equals the current query stamp.
+  //
+  std::vector<uint32_t> _queryStamps;
+  uint32_t _queryStamp;
+};
+
+#endif
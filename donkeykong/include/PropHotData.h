@@ -0,0 +1,59 @@
+#ifndef _PIXIRETRO_GAME_PROPHOTDATA_H_
+#define _PIXIRETRO_GAME_PROPHOTDATA_H_
+
+#include <vector>
+#include <cstdint>
+
+//
+// Structure-of-arrays storage for the prop data read every tick by the level. Each prop owns
+// a single index into every array and writes its data there whenever it changes. Passes over
+// all props (interaction tests, debug draws) can then stream through contiguous memory rather
+// than hop between prop instances.
+//
+struct PropHotData
+{
+  //
+  // Bit flags for the effects a prop has on actors in its current state.
+  //
+  enum EffectFlag : uint8_t
+  {
+    EFFECT_SUPPORT  = 1 << 0,
+    EFFECT_LADDER   = 1 << 1,
+    EFFECT_CONVEYOR = 1 << 2,
+    EFFECT_KILLER   = 1 << 3
+  };
+
+  //
+  // Appends a new zeroed element to every array and returns its index.
+  //
+  int add();
+
+  void clear();
+
+  int size() const {return static_cast<int>(_positionX.size());}
+
+  //
+  // Current position of each prop w.r.t world space (includes the transition displacement).
+  //
+  std::vector<float> _positionX;
+  std::vector<float> _positionY;
+
+  //
+  // The interaction box of each prop w.r.t world space, as returned from
+  // Prop::getInteractionBox.
+  //
+  std::vector<float> _boxXMin;
+  std::vector<float> _boxXMax;
+  std::vector<float> _boxYMin;
+  std::vector<float> _boxYMax;
+
+  //
+  // Combination of EffectFlag bits.
+  //
+  std::vector<uint8_t> _effects;
+
+  std::vector<int> _currentState;
+  std::vector<float> _stateClock;
+};
+
+#endif
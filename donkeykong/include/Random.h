@@ -0,0 +1,37 @@
+#ifndef _PIXIRETRO_GAME_RANDOM_H_
+#define _PIXIRETRO_GAME_RANDOM_H_
+
+#include <cstdint>
+
+//
+// The random numbers used by game logic (random animation frames and prop state changes).
+// Unlike pxr::rand the generator can be seeded, so a run replayed with the same seed and
+// inputs makes the same choices; replays record the seed they were recorded with.
+//
+// Seeded from std::random_device at startup. Not thread safe; game thread only.
+//
+class Random final
+{
+public:
+
+  //
+  // Restarts the sequence from 'seed'.
+  //
+  static void seed(uint64_t seed);
+
+  //
+  // Returns a seed from std::random_device, for runs which should differ.
+  //
+  static uint64_t makeSeed();
+
+  //
+  // Uniform in the closed interval [lo, hi].
+  //
+  static int uniformSignedInt(int lo, int hi);
+  static unsigned uniformUnsignedInt(unsigned lo, unsigned hi);
+
+private:
+  Random() = delete;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef _PIXIRETRO_GAME_RASTERIZER_H_
+#define _PIXIRETRO_GAME_RASTERIZER_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "pixiretro/pxr_gfx.h"
+#include "pixiretro/pxr_vec.h"
+#include "pixiretro/pxr_rect.h"
+#include "SpritesheetData.h"
+#include "RenderBuffer.h"
+
+//
+// A CPU renderer drawing sprites and rectangles into RGBA framebuffers ('screens'), with
+// the same semantics as the engine's pxr::gfx calls. Used by the headless backend to render
+// without a window and to produce byte exact frames for comparison.
+//
+// Sprites are blitted from the decoded spritesheet bitmaps (see SpritesheetData). Pixels
+// with zero alpha are transparent and skipped; all other pixels are written as is, there is
+// no blending. Rows are blitted 8 (AVX2) or 4 (SSE2) pixels at a time, the instruction set
+// chosen at runtime as in the AABB kernel, else a pixel at a time; all paths give identical
+// output.
+//
+// Text is not rasterized.
+//
+class Rasterizer
+{
+public:
+
+  //
+  // Pixels are packed RGBA as in SpritesheetData; rows are stored bottom-up to match the
+  // y-up screen space.
+  //
+  struct Screen
+  {
+    pxr::Vector2i _size;
+    std::vector<uint32_t> _pixels;
+  };
+
+  Rasterizer();
+  ~Rasterizer() = default;
+
+  Rasterizer(const Rasterizer&) = delete;
+  Rasterizer& operator=(const Rasterizer&) = delete;
+
+  int createScreen(pxr::Vector2i size);
+
+  void addSpritesheet(pxr::gfx::ResourceKey_t key, std::shared_ptr<const SpritesheetData> data);
+  void removeSpritesheet(pxr::gfx::ResourceKey_t key);
+
+  void clearScreenShade(int shade, int screenid);
+  void clearScreenTransparent(int screenid);
+
+  //
+  // Draws a sprite with its origin at position. Draws of unknown spritesheets or sprites
+  // are ignored.
+  //
+  void drawSprite(pxr::Vector2i position, pxr::gfx::ResourceKey_t spritesheetKey,
+                  pxr::gfx::SpriteId_t spriteid, int screenid, bool mirrorX, bool mirrorY);
+
+  void drawFillRectangle(const pxr::iRect& rect, pxr::gfx::Color4u color, int screenid);
+  void drawBorderRectangle(const pxr::iRect& rect, pxr::gfx::Color4u color, int screenid);
+
+  //
+  // Executes every command of a render buffer against this rasterizer.
+  //
+  void execute(const RenderBuffer& renderBuffer);
+
+  const Screen& getScreen(int screenid) const;
+  int getScreenCount() const {return _screens.size();}
+
+  //
+  // Composites all screens, in the order they were created, into 'pixels'. Later screens
+  // cover earlier ones except where they are transparent. All screens must be the same
+  // size.
+  //
+  void composite(std::vector<uint32_t>& pixels) const;
+
+private:
+  void fillRow(Screen& screen, int row, int colBegin, int colEnd, uint32_t pixel);
+
+private:
+  std::vector<Screen> _screens;
+  std::unordered_map<pxr::gfx::ResourceKey_t, std::shared_ptr<const SpritesheetData>> _spritesheets;
+};
+
+#endif
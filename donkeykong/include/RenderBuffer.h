@@ -0,0 +1,106 @@
+#ifndef _PIXIRETRO_GAME_RENDERBUFFER_H_
+#define _PIXIRETRO_GAME_RENDERBUFFER_H_
+
+#include <string>
+#include <vector>
+#include "pixiretro/pxr_gfx.h"
+#include "pixiretro/pxr_vec.h"
+#include "pixiretro/pxr_rect.h"
+
+//
+// A render command recorded for later execution by a render buffer.
+//
+struct RenderCommand
+{
+  enum Type
+  {
+    RENDER_SPRITE,
+    RENDER_FILL_RECTANGLE,
+    RENDER_BORDER_RECTANGLE,
+    RENDER_CLEAR_SHADE,
+    RENDER_CLEAR_TRANSPARENT,
+    RENDER_TEXT
+  };
+
+  Type _type;
+  int _screenid;
+
+  //
+  // sprite position, rect position or text position.
+  //
+  pxr::Vector2i _position;
+
+  //
+  // RENDER_SPRITE: spritesheet key and sprite id.
+  // RENDER_FILL/BORDER_RECTANGLE: rect size.
+  // RENDER_CLEAR_SHADE: shade in _a.
+  // RENDER_TEXT: font key in _a; text offset into the buffer's text store and length.
+  //
+  int _a;
+  int _b;
+  int _textOffset;
+  int _textLength;
+
+  pxr::gfx::Color4u _color;
+  bool _mirrorX;
+  bool _mirrorY;
+};
+
+//
+// A linear buffer of the render commands of a frame. Drawing code appends commands to the
+// buffer rather than calling pxr::gfx directly; the backend stage (execute) then replays the
+// commands, in order, against pxr::gfx. Separating the two lets a frame be inspected or
+// recorded before it is drawn, and lets execution be moved away from the game loop.
+//
+// The buffer keeps its storage across clears so a steady state frame does not allocate.
+//
+class RenderBuffer
+{
+public:
+  RenderBuffer();
+  ~RenderBuffer() = default;
+
+  RenderBuffer(const RenderBuffer&) = default;
+  RenderBuffer& operator=(const RenderBuffer&) = default;
+
+  RenderBuffer(RenderBuffer&&) = default;
+  RenderBuffer& operator=(RenderBuffer&&) = default;
+
+  void clear();
+
+  void drawSprite(pxr::Vector2i position, pxr::gfx::ResourceKey_t spritesheetKey,
+                  pxr::gfx::SpriteId_t spriteid, int screenid, bool mirrorX, bool mirrorY);
+
+  void drawFillRectangle(const pxr::iRect& rect, pxr::gfx::Color4u color, int screenid);
+  void drawBorderRectangle(const pxr::iRect& rect, pxr::gfx::Color4u color, int screenid);
+
+  void clearScreenShade(int shade, int screenid);
+  void clearScreenTransparent(int screenid);
+
+  void drawText(pxr::Vector2i position, const std::string& text, pxr::gfx::ResourceKey_t fontKey,
+                int screenid);
+
+  //
+  // Executes every command in the order it was appended. The buffer is not cleared.
+  //
+  void execute() const;
+
+  const std::vector<RenderCommand>& getCommands() const {return _commands;}
+
+  int getCommandCount() const {return _commands.size();}
+
+  //
+  // The text of a RENDER_TEXT command.
+  //
+  std::string getText(const RenderCommand& command) const;
+
+private:
+  std::vector<RenderCommand> _commands;
+
+  //
+  // The characters of all text commands, stored contiguously.
+  //
+  std::string _text;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef _PIXIRETRO_GAME_RESOURCECACHE_H_
+#define _PIXIRETRO_GAME_RESOURCECACHE_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "pixiretro/pxr_gfx.h"
+#include "pixiretro/pxr_sfx.h"
+#include "SpritesheetData.h"
+
+//
+// Name keyed, reference counted cache of the engine resources loaded by the game. Every
+// loader acquires spritesheets and sounds through the cache rather than from the engine, so
+// each is loaded into the engine once however many users it has, and is unloaded when the
+// last user releases it.
+//
+// The cache also holds the CPU side copies of spritesheets (SpritesheetData) while they are
+// in use in headless builds, and reports the memory of every cached asset.
+//
+class ResourceCache final
+{
+public:
+
+  static constexpr const char* RESOURCE_PATH_SOUNDS {"assets/sounds/"};
+  static constexpr const char* SOUND_FILE_EXTENSION {".wav"};
+
+  ~ResourceCache() = default;
+
+  static bool initialize();
+
+  //
+  // Unloads everything still cached, regardless of references.
+  //
+  static void shutdown();
+
+  //
+  // Returns the engine key of the spritesheet, loading it on the first acquire. Each acquire
+  // must be paired with a release.
+  //
+  static pxr::gfx::ResourceKey_t acquireSpritesheet(const std::string& name);
+  static void releaseSpritesheet(const std::string& name);
+
+  static pxr::sfx::ResourceKey_t acquireSound(const std::string& name);
+  static void releaseSound(const std::string& name);
+
+  //
+  // Attaches the CPU copy of an acquired spritesheet, so others can share it via
+  // getSpritesheetData. It is released with the spritesheet.
+  //
+  static void attachSpritesheetData(const std::string& name, std::shared_ptr<const SpritesheetData> data);
+
+  //
+  // Returns the CPU copy of a spritesheet if one is attached, else nullptr.
+  //
+  static std::shared_ptr<const SpritesheetData> getSpritesheetData(const std::string& name);
+
+  //
+  // Logs every cached asset with its reference count and size in bytes. Spritesheet sizes
+  // are the decoded size if the data is attached, else the file size; sound sizes are the
+  // file size.
+  //
+  static void logReport();
+
+private:
+  struct Spritesheet
+  {
+    pxr::gfx::ResourceKey_t _key;
+    int _refs;
+    std::shared_ptr<const SpritesheetData> _data;
+  };
+
+  struct Sound
+  {
+    pxr::sfx::ResourceKey_t _key;
+    int _refs;
+  };
+
+  static std::unique_ptr<ResourceCache> instance;
+
+private:
+  ResourceCache() = default;
+
+private:
+  std::unordered_map<std::string, Spritesheet> _spritesheets;
+  std::unordered_map<std::string, Sound> _sounds;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef _PIXIRETRO_GAME_SPRITEMASK_H_
+#define _PIXIRETRO_GAME_SPRITEMASK_H_
+
+#include <array>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "pixiretro/pxr_vec.h"
+#include "pixiretro/pxr_rect.h"
+
+//
+// A packed 1-bit opacity mask of a single sprite, used for pixel perfect collision tests
+// without reading spritesheet pixels.
+//
+// Each row of the sprite is stored as one or more 64-bit words where bit c (of the row as a
+// whole) is set if column c of the sprite is opaque. Column 0 is the left most column and
+// maps to bit 0 of word 0. Bits beyond the sprite width are always zero. A copy mirrored in
+// the x-axis is precomputed so mirrored sprites cost the same to test.
+//
+//    row 2 : 0 1 1 0 ...        world x of column c = position._x - origin._x + c
+//    row 1 : 1 1 1 1 ...        world y of row r    = position._y - origin._y + r
+//    row 0 : 0 1 1 0 ...
+//
+// To reject near misses without reading the mask rows, each mask also stores the tight bounds
+// of its opaque pixels and a coarse occupancy map of 8x8 pixel tiles. A tile is occupied if
+// any of its pixels are opaque. Tiles are aligned to the bottom-left of the sprite. Both are
+// precomputed for every combination of mirroring.
+//
+class SpriteMask
+{
+public:
+
+  static constexpr int bitsPerWord {64};
+  static constexpr int tileSize {8};
+
+  //
+  // Builds the mask of the sprite which occupies 'rect' of its spritesheet image (x, y is the
+  // bottom-left corner), with 'origin' w.r.t the bottom-left corner of the rect. The pixel at
+  // (col, row) of the image is opaque if isOpaque(col, row).
+  //
+  SpriteMask(pxr::iRect rect, pxr::Vector2i origin, const std::function<bool(int, int)>& isOpaque);
+
+  ~SpriteMask() = default;
+
+  SpriteMask(const SpriteMask&) = default;
+  SpriteMask& operator=(const SpriteMask&) = default;
+
+  SpriteMask(SpriteMask&&) = default;
+  SpriteMask& operator=(SpriteMask&&) = default;
+
+  pxr::Vector2i getSize() const {return _size;}
+  pxr::Vector2i getOrigin() const {return _origin;}
+
+  int getWordsPerRow() const {return _wordsPerRow;}
+
+  //
+  // Returns the words of a row. Row 0 is the bottom row of the sprite.
+  //
+  const uint64_t* getRow(int row, bool mirrorX) const;
+
+  //
+  // The smallest rect which contains all opaque pixels w.r.t the bottom-left corner of the
+  // sprite. Has zero width and height if the sprite has no opaque pixels.
+  //
+  const pxr::iRect& getOpaqueBounds(bool mirrorX, bool mirrorY) const;
+
+  //
+  // The number of columns and rows of tiles which cover the sprite.
+  //
+  pxr::Vector2i getTileCount() const {return _tileCount;}
+
+  //
+  // Is the tile at (col, row) occupied; tile (0, 0) is the bottom-left tile.
+  //
+  bool isTileOccupied(int col, int row, bool mirrorX, bool mirrorY) const;
+
+private:
+
+  //
+  // Index of the data for a combination of mirroring.
+  //
+  static int toMirrorIndex(bool mirrorX, bool mirrorY) {return (mirrorX ? 1 : 0) + (mirrorY ? 2 : 0);}
+
+private:
+  pxr::Vector2i _size;
+  pxr::Vector2i _origin;
+  int _wordsPerRow;
+  std::vector<uint64_t> _rows;
+  std::vector<uint64_t> _rowsMirrorX;
+
+  std::array<pxr::iRect, 4> _opaqueBounds;
+
+  pxr::Vector2i _tileCount;
+  std::array<std::vector<bool>, 4> _tiles;
+};
+
+//
+// A sprite mask positioned in world space; the position is that of the sprite origin, as
+// passed to the draw call which draws the sprite.
+//
+struct MaskSubject
+{
+  pxr::Vector2i _position;
+  const SpriteMask* _mask;
+  bool _mirrorX;
+  bool _mirrorY;
+};
+
+//
+// The tests below are ordered from cheapest to most expensive; each is conservative, never
+// rejecting subjects whose opaque pixels overlap, thus they can be chained to exit early.
+//
+
+//
+// Returns true if the opaque bounds of the two subjects overlap.
+//
+bool isOpaqueBoundsIntersection(const MaskSubject& a, const MaskSubject& b);
+
+//
+// Returns true if any occupied tiles of the two subjects overlap.
+//
+bool isTileIntersection(const MaskSubject& a, const MaskSubject& b);
+
+//
+// Returns true if any opaque pixels of the two subjects overlap.
+//
+bool isMaskIntersection(const MaskSubject& a, const MaskSubject& b);
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _PIXIRETRO_GAME_SPRITESHEETDATA_H_
+#define _PIXIRETRO_GAME_SPRITESHEETDATA_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+//
+// A CPU side copy of a spritesheet; the decoded pixels of the spritesheet bitmap and the
+// sprite metadata from the spritesheet file. This is the same data the engine loads to draw
+// sprites; engine builds read it back via pxr::gfx::getSpritesheet, but the headless backend
+// keeps no pixels of its own, so headless builds (and the rasterizer) decode this copy.
+//
+// Pixel rows are stored bottom-up, i.e. row 0 is the bottom row of the image, matching the
+// y-up world space and the sprite coordinates given in spritesheet files.
+//
+struct SpritesheetData
+{
+  static constexpr const char* RESOURCE_PATH_SPRITESHEETS {"assets/spritesheets/"};
+  static constexpr const char* BITMAP_FILE_EXTENSION {".bmp"};
+  static constexpr const char* SPRITESHEET_FILE_EXTENSION {".spritesheet"};
+
+  //
+  // A sprite as defined in a spritesheet file; a rect within the spritesheet image (x, y
+  // is the bottom-left corner) and an origin w.r.t the bottom-left corner of the rect.
+  //
+  struct Sprite
+  {
+    int _x;
+    int _y;
+    int _w;
+    int _h;
+    int _ox;
+    int _oy;
+  };
+
+  //
+  // Returns the pixel at (col, row) of the image in packed RGBA form, that is the bytes are
+  // in R, G, B, A order in memory.
+  //
+  uint32_t getPixel(int col, int row) const {return _pixels[(row * _width) + col];}
+
+  //
+  // Is the pixel at (col, row) of the image visible when drawn.
+  //
+  bool isOpaque(int col, int row) const {return (getPixel(col, row) >> 24) != 0;}
+
+  std::string _name;
+  int _width;
+  int _height;
+  std::vector<uint32_t> _pixels;
+  std::vector<Sprite> _sprites;
+};
+
+//
+// Loads the bitmap and spritesheet file pair of the spritesheet with 'name' from the
+// spritesheets resource directory. Returns true on success else false; errors are logged.
+//
+// Supports uncompressed 24 and 32 bit bitmaps (with or without bitfield masks).
+//
+bool loadSpritesheetData(const std::string& name, SpritesheetData* data);
+
+//
+// The two halves of loadSpritesheetData, for loading spritesheets in parallel. The bitmap
+// half does no logging and touches no shared state so is safe to call from any thread; on
+// failure 'error' is set to a message for the caller to log. The sprites half parses the
+// spritesheet file and must be called from the main thread.
+//
+bool loadSpritesheetBitmap(const std::string& name, SpritesheetData* data, const char** error);
+bool loadSpritesheetSprites(const std::string& name, SpritesheetData* data);
+
+#endif
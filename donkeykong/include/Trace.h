@@ -0,0 +1,103 @@
+#ifndef _PIXIRETRO_GAME_TRACE_H_
+#define _PIXIRETRO_GAME_TRACE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+//
+// Records trace events to a Chrome trace event format (JSON) file, viewable in Perfetto or
+// chrome://tracing. Events are queued by the calling thread and formatted and written to
+// disk by a background writer thread, so tracing a long session costs the game loop little
+// more than a lock and a copy per event.
+//
+// Tracing is enabled at build time by defining DK_TRACING (meson -Dtracing=true). Without it
+// every call below is an empty inline function and TraceScope is an empty object, so the
+// instrumentation compiles away.
+//
+class Trace final
+{
+public:
+
+#ifdef DK_TRACING
+  static constexpr bool isEnabled {true};
+#else
+  static constexpr bool isEnabled {false};
+#endif
+
+  //
+  // The file (w.r.t game root dir) the trace is written to.
+  //
+  static constexpr const char* TRACE_FILE_PATH {"trace.json"};
+
+  using Clock_t = std::chrono::steady_clock;
+
+  //
+  // Opens the trace file and starts the writer thread. Returns false (and logs) if the file
+  // cannot be opened, in which case events are discarded.
+  //
+  static bool initialize();
+
+  //
+  // Writes all queued events, closes the trace file and stops the writer thread. Also run at
+  // exit, so a trace is complete even if the game leaves through std::exit.
+  //
+  static void shutdown();
+
+  //
+  // Records an event spanning [start, end]. 'name' must be a string literal (or otherwise
+  // outlive the trace session); it is not copied.
+  //
+  static void completeEvent(const char* name, Clock_t::time_point start, Clock_t::time_point end)
+  {
+    if constexpr (isEnabled)
+      pushEvent('X', name, nullptr, 0, start, end);
+  }
+
+  //
+  // Records an instant event with a detail string and integer argument, both shown in the
+  // event args. Unlike 'name', 'detail' is copied (and truncated if long) so it need only
+  // live for the call.
+  //
+  static void instantEvent(const char* name, const char* detail, int value)
+  {
+    if constexpr (isEnabled){
+      auto now = Clock_t::now();
+      pushEvent('i', name, detail, value, now, now);
+    }
+  }
+
+private:
+  Trace() = delete;
+
+  static void pushEvent(char phase, const char* name, const char* detail, int value,
+                        Clock_t::time_point start, Clock_t::time_point end);
+};
+
+//
+// Records a complete event for the lifetime of the instance.
+//
+class TraceScope
+{
+public:
+  explicit TraceScope(const char* name) : _name{name}
+  {
+    if constexpr (Trace::isEnabled)
+      _start = Trace::Clock_t::now();
+  }
+
+  ~TraceScope()
+  {
+    if constexpr (Trace::isEnabled)
+      Trace::completeEvent(_name, _start, Trace::Clock_t::now());
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+  const char* _name;
+  Trace::Clock_t::time_point _start;
+};
+
+#endif
@@ -144,6 +144,27 @@ public:
   //
   float getSpeed() const;
 
+  //
+  // The progress of a transition along its paths; restoring it to a transition with the
+  // same paths returns it to where it was captured.
+  //
+  struct Snapshot
+  {
+    pxr::Vector2f _position;
+    pxr::Vector2f _direction;
+    float _speed;
+    float _lerpClock;
+    int _fromPosition;
+    int _toPosition;
+    int _fromSpeed;
+    int _toSpeed;
+    bool _isMoving;
+    bool _isAccelerating;
+  };
+
+  Snapshot getSnapshot() const;
+  void restore(const Snapshot& snapshot);
+
 private:
 
   //
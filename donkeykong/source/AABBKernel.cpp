@@ -0,0 +1,265 @@
+#include <cassert>
+#include "AABBKernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+  #define DK_AABB_KERNEL_SSE2
+  #include <emmintrin.h>
+  #if defined(__GNUC__)
+    #define DK_AABB_KERNEL_AVX2
+    #include <immintrin.h>
+  #endif
+#endif
+
+using ContiguousKernel_t = int (*)(const pxr::AABB&, const AABBArrays&, int, int*);
+using IndexedKernel_t = int (*)(const pxr::AABB&, const AABBArrays&, const int*, int, int*);
+
+//
+// Appends the indices of the set bits in a lane mask to the hits array without branching
+// on each lane, thus dense and sparse hit patterns cost the same.
+//
+static inline int compactHits(int mask, int laneCount, const int* laneIndices, int* hits, int hitCount)
+{
+  for(int lane = 0; lane < laneCount; ++lane){
+    hits[hitCount] = laneIndices[lane];
+    hitCount += (mask >> lane) & 1;
+  }
+  return hitCount;
+}
+
+static inline bool isIntersection(const pxr::AABB& query, const AABBArrays& boxes, int i)
+{
+  return boxes._xmin[i] <= query._xmax && boxes._xmax[i] >= query._xmin &&
+         boxes._ymin[i] <= query._ymax && boxes._ymax[i] >= query._ymin;
+}
+
+//
+// SCALAR ////////////////////////////////////////////////////////////////////////////////////////
+//
+
+[[maybe_unused]]
+static int scalarContiguous(const pxr::AABB& query, const AABBArrays& boxes, int count, int* hits)
+{
+  int hitCount {0};
+  for(int i = 0; i < count; ++i){
+    hits[hitCount] = i;
+    hitCount += isIntersection(query, boxes, i);
+  }
+  return hitCount;
+}
+
+[[maybe_unused]]
+static int scalarIndexed(const pxr::AABB& query, const AABBArrays& boxes, const int* indices,
+                         int count, int* hits)
+{
+  int hitCount {0};
+  for(int i = 0; i < count; ++i){
+    hits[hitCount] = indices[i];
+    hitCount += isIntersection(query, boxes, indices[i]);
+  }
+  return hitCount;
+}
+
+//
+// SSE2 //////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#ifdef DK_AABB_KERNEL_SSE2
+
+static inline int sse2Mask(__m128 xmin, __m128 xmax, __m128 ymin, __m128 ymax,
+                           __m128 qxmin, __m128 qxmax, __m128 qymin, __m128 qymax)
+{
+  __m128 x = _mm_and_ps(_mm_cmple_ps(xmin, qxmax), _mm_cmpge_ps(xmax, qxmin));
+  __m128 y = _mm_and_ps(_mm_cmple_ps(ymin, qymax), _mm_cmpge_ps(ymax, qymin));
+  return _mm_movemask_ps(_mm_and_ps(x, y));
+}
+
+static int sse2Contiguous(const pxr::AABB& query, const AABBArrays& boxes, int count, int* hits)
+{
+  const __m128 qxmin = _mm_set1_ps(query._xmin);
+  const __m128 qxmax = _mm_set1_ps(query._xmax);
+  const __m128 qymin = _mm_set1_ps(query._ymin);
+  const __m128 qymax = _mm_set1_ps(query._ymax);
+
+  int hitCount {0};
+  int i {0};
+  for(; i + 4 <= count; i += 4){
+    int mask = sse2Mask(_mm_loadu_ps(boxes._xmin + i), _mm_loadu_ps(boxes._xmax + i),
+                        _mm_loadu_ps(boxes._ymin + i), _mm_loadu_ps(boxes._ymax + i),
+                        qxmin, qxmax, qymin, qymax);
+    if(mask == 0)
+      continue;
+    const int lanes[4] {i, i + 1, i + 2, i + 3};
+    hitCount = compactHits(mask, 4, lanes, hits, hitCount);
+  }
+
+  for(; i < count; ++i){
+    hits[hitCount] = i;
+    hitCount += isIntersection(query, boxes, i);
+  }
+
+  return hitCount;
+}
+
+static int sse2Indexed(const pxr::AABB& query, const AABBArrays& boxes, const int* indices,
+                       int count, int* hits)
+{
+  const __m128 qxmin = _mm_set1_ps(query._xmin);
+  const __m128 qxmax = _mm_set1_ps(query._xmax);
+  const __m128 qymin = _mm_set1_ps(query._ymin);
+  const __m128 qymax = _mm_set1_ps(query._ymax);
+
+  auto gather = [indices](const float* array, int i){
+    return _mm_set_ps(array[indices[i + 3]], array[indices[i + 2]],
+                      array[indices[i + 1]], array[indices[i]]);
+  };
+
+  int hitCount {0};
+  int i {0};
+  for(; i + 4 <= count; i += 4){
+    int mask = sse2Mask(gather(boxes._xmin, i), gather(boxes._xmax, i),
+                        gather(boxes._ymin, i), gather(boxes._ymax, i),
+                        qxmin, qxmax, qymin, qymax);
+    if(mask == 0)
+      continue;
+    hitCount = compactHits(mask, 4, indices + i, hits, hitCount);
+  }
+
+  for(; i < count; ++i){
+    hits[hitCount] = indices[i];
+    hitCount += isIntersection(query, boxes, indices[i]);
+  }
+
+  return hitCount;
+}
+
+#endif
+
+//
+// AVX2 //////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#ifdef DK_AABB_KERNEL_AVX2
+
+__attribute__((target("avx2")))
+static inline int avx2Mask(__m256 xmin, __m256 xmax, __m256 ymin, __m256 ymax,
+                           __m256 qxmin, __m256 qxmax, __m256 qymin, __m256 qymax)
+{
+  __m256 x = _mm256_and_ps(_mm256_cmp_ps(xmin, qxmax, _CMP_LE_OQ),
+                           _mm256_cmp_ps(xmax, qxmin, _CMP_GE_OQ));
+  __m256 y = _mm256_and_ps(_mm256_cmp_ps(ymin, qymax, _CMP_LE_OQ),
+                           _mm256_cmp_ps(ymax, qymin, _CMP_GE_OQ));
+  return _mm256_movemask_ps(_mm256_and_ps(x, y));
+}
+
+__attribute__((target("avx2")))
+static int avx2Contiguous(const pxr::AABB& query, const AABBArrays& boxes, int count, int* hits)
+{
+  const __m256 qxmin = _mm256_set1_ps(query._xmin);
+  const __m256 qxmax = _mm256_set1_ps(query._xmax);
+  const __m256 qymin = _mm256_set1_ps(query._ymin);
+  const __m256 qymax = _mm256_set1_ps(query._ymax);
+  const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+  int hitCount {0};
+  int i {0};
+  for(; i + 8 <= count; i += 8){
+    int mask = avx2Mask(_mm256_loadu_ps(boxes._xmin + i), _mm256_loadu_ps(boxes._xmax + i),
+                        _mm256_loadu_ps(boxes._ymin + i), _mm256_loadu_ps(boxes._ymax + i),
+                        qxmin, qxmax, qymin, qymax);
+    if(mask == 0)
+      continue;
+    alignas(32) int lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes),
+                       _mm256_add_epi32(_mm256_set1_epi32(i), laneOffsets));
+    hitCount = compactHits(mask, 8, lanes, hits, hitCount);
+  }
+
+  for(; i < count; ++i){
+    hits[hitCount] = i;
+    hitCount += isIntersection(query, boxes, i);
+  }
+
+  return hitCount;
+}
+
+__attribute__((target("avx2")))
+static int avx2Indexed(const pxr::AABB& query, const AABBArrays& boxes, const int* indices,
+                       int count, int* hits)
+{
+  const __m256 qxmin = _mm256_set1_ps(query._xmin);
+  const __m256 qxmax = _mm256_set1_ps(query._xmax);
+  const __m256 qymin = _mm256_set1_ps(query._ymin);
+  const __m256 qymax = _mm256_set1_ps(query._ymax);
+
+  int hitCount {0};
+  int i {0};
+  for(; i + 8 <= count; i += 8){
+    __m256i vindices = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+    int mask = avx2Mask(_mm256_i32gather_ps(boxes._xmin, vindices, 4),
+                        _mm256_i32gather_ps(boxes._xmax, vindices, 4),
+                        _mm256_i32gather_ps(boxes._ymin, vindices, 4),
+                        _mm256_i32gather_ps(boxes._ymax, vindices, 4),
+                        qxmin, qxmax, qymin, qymax);
+    if(mask == 0)
+      continue;
+    hitCount = compactHits(mask, 8, indices + i, hits, hitCount);
+  }
+
+  for(; i < count; ++i){
+    hits[hitCount] = indices[i];
+    hitCount += isIntersection(query, boxes, indices[i]);
+  }
+
+  return hitCount;
+}
+
+#endif
+
+//
+// DISPATCH //////////////////////////////////////////////////////////////////////////////////////
+//
+
+struct Kernel
+{
+  ContiguousKernel_t _contiguous;
+  IndexedKernel_t _indexed;
+  const char* _name;
+};
+
+static Kernel selectKernel()
+{
+#ifdef DK_AABB_KERNEL_AVX2
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2"))
+    return Kernel{avx2Contiguous, avx2Indexed, "avx2"};
+#endif
+#ifdef DK_AABB_KERNEL_SSE2
+  return Kernel{sse2Contiguous, sse2Indexed, "sse2"};
+#else
+  return Kernel{scalarContiguous, scalarIndexed, "scalar"};
+#endif
+}
+
+static const Kernel& getKernel()
+{
+  static const Kernel kernel {selectKernel()};
+  return kernel;
+}
+
+int findAABBIntersections(const pxr::AABB& query, const AABBArrays& boxes, int count, int* hits)
+{
+  assert(count >= 0);
+  return getKernel()._contiguous(query, boxes, count, hits);
+}
+
+int findAABBIntersections(const pxr::AABB& query, const AABBArrays& boxes, const int* indices,
+                          int count, int* hits)
+{
+  assert(count >= 0);
+  return getKernel()._indexed(query, boxes, indices, count, hits);
+}
+
+const char* getAABBKernelName()
+{
+  return getKernel()._name;
+}
@@ -1,8 +1,8 @@
 #include <cassert>
 #include "pixiretro/pxr_gfx.h"
-#include "pixiretro/pxr_rand.h"
 #include "Animation.h"
 #include "AnimationFactory.h"
+#include "Random.h"
 
 Animation::Animation() :
   _def{nullptr},
@@ -25,24 +25,27 @@ Animation::Animation(std::shared_ptr<const Definition> def) :
 }
 
 Animation::Definition::Definition(
-  std::string                       name,
-  Mode                              mode,
-  pxr::gfx::ResourceKey_t           spritesheetKey,
-  std::vector<pxr::gfx::SpriteId_t> frames,
-  float                             frequency,
-  bool                              baseMirrorX,
-  bool                              baseMirrorY)
+  std::string                                    name,
+  Mode                                           mode,
+  pxr::gfx::ResourceKey_t                        spritesheetKey,
+  std::vector<pxr::gfx::SpriteId_t>              frames,
+  std::vector<std::shared_ptr<const SpriteMask>> frameMasks,
+  float                                          frequency,
+  bool                                           baseMirrorX,
+  bool                                           baseMirrorY)
   :
   _name{name},
   _mode{mode},
   _spritesheetKey{spritesheetKey},
   _frames{std::move(frames)},
+  _frameMasks{std::move(frameMasks)},
   _frequency{frequency},
   _baseMirrorX{baseMirrorX},
   _baseMirrorY{baseMirrorY}
 {
   assert(_name.size() > 0);
   assert(_frequency >= 0.f);
+  assert(_frameMasks.size() == _frames.size());
   _period = 1.f / _frequency;
 }
 
@@ -69,18 +72,24 @@ void Animation::onUpdate(float dt)
       _frameNo = _def->_frames.size() - 1;
     break;
   case Mode::RANDOM:
-    _frameNo = pxr::rand::uniformUnsignedInt(0, _def->_frames.size() - 1);
+    _frameNo = Random::uniformUnsignedInt(0, _def->_frames.size() - 1);
     break;
   }
     
   _clock = 0.f;
 }
 
-void Animation::onDraw(pxr::Vector2i position, int screenid)
+void Animation::onDraw(pxr::Vector2i position, int layer, DrawList& drawList)
 {
   assert(_def != nullptr); 
-  pxr::gfx::drawSprite(position, _def->_spritesheetKey, _def->_frames[_frameNo], screenid, 
-                       _mirrorX, _mirrorY);
+  const SpriteMask& mask = getSpriteMask();
+  pxr::iRect bounds {};
+  bounds._x = position._x - mask.getOrigin()._x;
+  bounds._y = position._y - mask.getOrigin()._y;
+  bounds._w = mask.getSize()._x;
+  bounds._h = mask.getSize()._y;
+  drawList.push(DrawCommand{layer, _def->_spritesheetKey, _def->_frames[_frameNo], position, 
+                            _mirrorX, _mirrorY, bounds});
 }
 
 void Animation::reset()
@@ -90,6 +99,16 @@ void Animation::reset()
   _clock = 0.f;
 }
 
+void Animation::restore(const Snapshot& snapshot)
+{
+  assert(_def != nullptr);
+  assert(0 <= snapshot._frameNo && snapshot._frameNo < static_cast<int>(_def->_frames.size()));
+  _frameNo = snapshot._frameNo;
+  _clock = snapshot._clock;
+  _mirrorX = snapshot._mirrorX;
+  _mirrorY = snapshot._mirrorY;
+}
+
 void Animation::setMirrorX(bool mirror)
 {
    _mirrorX = mirror ? !(_def->_baseMirrorX) : _def->_baseMirrorX;
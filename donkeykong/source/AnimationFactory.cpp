@@ -1,9 +1,16 @@
 #include <string.h>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <functional>
+#include <thread>
+#include <vector>
 #include "pixiretro/pxr_xml.h"
 #include "pixiretro/pxr_gfx.h"
 #include "pixiretro/pxr_log.h"
 #include "AnimationFactory.h"
+#include "ResourceCache.h"
+#include "SpritesheetData.h"
 #include "Animation.h"
 
 using namespace tinyxml2;
@@ -18,6 +25,8 @@ static constexpr const char* msg_load_abort = "aborting animation definitions fi
 static constexpr const char* msg_invalid_animation_mode = "invalid animation mode";
 static constexpr const char* msg_use_animation_mode_default = "using default animation mode";
 static constexpr const char* msg_missing_animation = "missing animation";
+static constexpr const char* msg_invalid_spriteid = "invalid sprite id in spritesheet";
+static constexpr const char* msg_spritesheet_fail = "failed to load spritesheet";
 
 bool AnimationFactory::initialize()
 {
@@ -26,7 +35,25 @@ bool AnimationFactory::initialize()
 
   instance = std::unique_ptr<AnimationFactory>{new AnimationFactory()};
   assert(instance != nullptr);
-  return instance->loadAnimationDefinitions();
+  if(!instance->loadAnimationDefinitions())
+    return false;
+  instance->indexDefinitions();
+  return true;
+}
+
+bool AnimationFactory::reload()
+{
+  assert(instance != nullptr);
+
+  auto defs = std::move(instance->_defs);
+  instance->_defs.clear();
+  if(!instance->loadAnimationDefinitions()){
+    instance->_defs = std::move(defs);
+    return false;
+  }
+
+  instance->indexDefinitions();
+  return true;
 }
 
 void AnimationFactory::shutdown()
@@ -34,24 +61,41 @@ void AnimationFactory::shutdown()
   if(instance == nullptr)
     return;
 
-  for(auto& pair : instance->_defs){
-    pxr::gfx::unloadSpritesheet(pair.second->_spritesheetKey);
-    pair.second.reset();
-  }
+  for(auto& pair : instance->_spritesheetKeys)
+    ResourceCache::releaseSpritesheet(pair.first);
 
   instance.reset(); 
 }
 
-Animation AnimationFactory::makeAnimation(const std::string& animationName)
+int AnimationFactory::findAnimation(const std::string& animationName)
 {
-  assert(animationName.size() > 0);
   assert(instance != nullptr);
-  auto search = instance->_defs.find(animationName);
-  if(search == instance->_defs.end()){
+  auto search = instance->_handles.find(animationName);
+  if(search == instance->_handles.end()){
     pxr::log::log(pxr::log::ERROR, msg_missing_animation, animationName);
-    assert(0);
+    return -1;
+  }
+  return search->second;
+}
+
+Animation AnimationFactory::makeAnimation(int handle)
+{
+  assert(instance != nullptr);
+  assert(0 <= handle && handle < static_cast<int>(instance->_handleDefs.size()));
+  return Animation{instance->_handleDefs[handle]};
+}
+
+void AnimationFactory::indexDefinitions()
+{
+  for(const auto& pair : _defs){
+    auto search = _handles.find(pair.first);
+    if(search != _handles.end()){
+      _handleDefs[search->second] = pair.second;
+      continue;
+    }
+    _handles.emplace(pair.first, static_cast<int>(_handleDefs.size()));
+    _handleDefs.push_back(pair.second);
   }
-  return Animation{search->second};
 }
 
 bool AnimationFactory::loadAnimationDefinitions()
@@ -81,6 +125,9 @@ bool AnimationFactory::loadAnimationDefinitions()
   if(!pxr::io::extractChildElement(&doc, &xmlanimations, "animations")) 
     return onerror();
 
+  if(!loadSpritesheets(xmlanimations))
+    return onerror();
+
   if(!pxr::io::extractChildElement(xmlanimations, &xmlanimation, "animation")) 
     return onerror();
 
@@ -90,7 +137,7 @@ bool AnimationFactory::loadAnimationDefinitions()
 
     const char* spritesheetName {nullptr};
     if(!pxr::io::extractStringAttribute(xmlanimation, "spritesheet", &spritesheetName)) return onerror();
-    pxr::gfx::ResourceKey_t spritesheetKey = pxr::gfx::loadSpritesheet(spritesheetName);
+    pxr::gfx::ResourceKey_t spritesheetKey = _spritesheetKeys.at(spritesheetName);
 
     float frequency {0.f};
     if(!pxr::io::extractFloatAttribute(xmlanimation, "frequency", &frequency)) return onerror();
@@ -121,10 +168,17 @@ bool AnimationFactory::loadAnimationDefinitions()
 
     std::vector<pxr::gfx::SpriteId_t> frames {};
 
+    std::vector<std::shared_ptr<const SpriteMask>> frameMasks {};
+
     do {
       pxr::gfx::SpriteId_t spriteid {0};
       if(!pxr::io::extractIntAttribute(xmlframe, "spriteid", &spriteid)) return onerror();
       frames.push_back(spriteid);
+
+      std::shared_ptr<const SpriteMask> mask = getSpriteMask(spritesheetName, spriteid);
+      if(mask == nullptr) return onerror();
+      frameMasks.push_back(std::move(mask));
+
       xmlframe = xmlframe->NextSiblingElement("frame");
     }
     while(xmlframe != 0);
@@ -134,6 +188,7 @@ bool AnimationFactory::loadAnimationDefinitions()
       animationMode,
       spritesheetKey,
       std::move(frames),
+      std::move(frameMasks),
       frequency,
       static_cast<bool>(baseMirrorX),
       static_cast<bool>(baseMirrorY)
@@ -148,6 +203,187 @@ bool AnimationFactory::loadAnimationDefinitions()
   }
   while(xmlanimation != 0);
 
+  _spriteMasks.clear();
+
   return true;
 }
 
+//
+// Calls work(i) for every i in [0, count) on a pool of worker threads which claim indices
+// in order; work must only write to per index slots.
+//
+static void runOnWorkers(size_t count, const std::function<void(size_t)>& work)
+{
+  std::atomic<size_t> next {0};
+  auto claim = [&](){
+    for(size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+      work(i);
+  };
+
+  size_t workerCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), count);
+  std::vector<std::thread> workers {};
+  for(size_t w = 0; w < workerCount; ++w)
+    workers.emplace_back(claim);
+
+  for(auto& worker : workers)
+    worker.join();
+}
+
+#ifdef DK_HEADLESS
+//
+// the headless backend keeps no spritesheet pixels, so masks are built from the game side
+// copy attached to the resource cache.
+//
+using SpritesheetSource = SpritesheetData;
+
+static const SpritesheetSource* findSpritesheet(
+  const std::unordered_map<std::string, pxr::gfx::ResourceKey_t>& keys,
+  const std::string& name)
+{
+  (void)keys;
+  return ResourceCache::getSpritesheetData(name).get();
+}
+
+static int getSpriteCount(const SpritesheetSource& sheet)
+{
+  return static_cast<int>(sheet._sprites.size());
+}
+
+static std::shared_ptr<const SpriteMask> makeSpriteMask(const SpritesheetSource& sheet, int spriteid)
+{
+  const SpritesheetData::Sprite& sprite = sheet._sprites[spriteid];
+  return std::make_shared<const SpriteMask>(
+    pxr::iRect{sprite._x, sprite._y, sprite._w, sprite._h},
+    pxr::Vector2i{sprite._ox, sprite._oy},
+    [&sheet](int col, int row){return sheet.isOpaque(col, row);}
+  );
+}
+#else
+using SpritesheetSource = pxr::gfx::Spritesheet;
+
+static const SpritesheetSource* findSpritesheet(
+  const std::unordered_map<std::string, pxr::gfx::ResourceKey_t>& keys,
+  const std::string& name)
+{
+  auto search = keys.find(name);
+  return search != keys.end() ? &pxr::gfx::getSpritesheet(search->second) : nullptr;
+}
+
+static int getSpriteCount(const SpritesheetSource& sheet)
+{
+  return static_cast<int>(sheet._sprites.size());
+}
+
+//
+// the engine's bitmap rows are bottom-up as stored in the file, as are sprite positions.
+//
+static std::shared_ptr<const SpriteMask> makeSpriteMask(const SpritesheetSource& sheet, int spriteid)
+{
+  const pxr::gfx::Sprite& sprite = sheet._sprites[spriteid];
+  const pxr::gfx::Color4u* const* pixels = sheet._image.getPixels();
+  return std::make_shared<const SpriteMask>(
+    pxr::iRect{sprite._position._x, sprite._position._y, sprite._size._x, sprite._size._y},
+    sprite._origin,
+    [pixels](int col, int row){return pixels[row][col]._a != 0;}
+  );
+}
+#endif
+
+bool AnimationFactory::loadSpritesheets(XMLElement* xmlanimations)
+{
+  std::vector<std::string> names {};
+
+  XMLElement* xmlanimation {nullptr};
+  if(!pxr::io::extractChildElement(xmlanimations, &xmlanimation, "animation"))
+    return false;
+
+  do {
+    const char* spritesheetName {nullptr};
+    if(!pxr::io::extractStringAttribute(xmlanimation, "spritesheet", &spritesheetName)) return false;
+    bool isLoaded = _spritesheetKeys.find(spritesheetName) != _spritesheetKeys.end();
+    if(!isLoaded && std::find(names.begin(), names.end(), spritesheetName) == names.end())
+      names.push_back(spritesheetName);
+    xmlanimation = xmlanimation->NextSiblingElement("animation");
+  }
+  while(xmlanimation != 0);
+
+  for(const auto& name : names)
+    _spritesheetKeys.emplace(name, ResourceCache::acquireSpritesheet(name));
+
+#ifdef DK_HEADLESS
+  std::vector<SpritesheetData> sheets(names.size());
+  std::vector<const char*> errors(names.size(), nullptr);
+  runOnWorkers(names.size(), [&](size_t i){
+    loadSpritesheetBitmap(names[i], &sheets[i], &errors[i]);
+  });
+
+  for(size_t i = 0; i < names.size(); ++i){
+    if(errors[i] != nullptr){
+      pxr::log::log(pxr::log::ERROR, errors[i], names[i]);
+      pxr::log::log(pxr::log::ERROR, msg_spritesheet_fail, names[i]);
+      return false;
+    }
+    if(!loadSpritesheetSprites(names[i], &sheets[i]))
+      return false;
+    ResourceCache::attachSpritesheetData(names[i], std::make_shared<const SpritesheetData>(std::move(sheets[i])));
+  }
+#endif
+
+  //
+  // build the masks of every sprite of the new spritesheets on the workers. The spritesheets
+  // are looked up here as the engine is not thread safe; the workers only read their pixels
+  // and write to disjoint mask slots.
+  //
+  struct MaskJob
+  {
+    const SpritesheetSource* _sheet;
+    int _spriteid;
+    std::shared_ptr<const SpriteMask>* _mask;
+  };
+
+  std::vector<MaskJob> jobs {};
+  for(const auto& name : names){
+    const SpritesheetSource* sheet = findSpritesheet(_spritesheetKeys, name);
+    if(sheet == nullptr){
+      pxr::log::log(pxr::log::ERROR, msg_spritesheet_fail, name);
+      return false;
+    }
+    auto& masks = _spriteMasks[name];
+    masks.resize(getSpriteCount(*sheet));
+    for(int spriteid = 0; spriteid < static_cast<int>(masks.size()); ++spriteid)
+      jobs.push_back({sheet, spriteid, &masks[spriteid]});
+  }
+
+  runOnWorkers(jobs.size(), [&](size_t i){
+    *(jobs[i]._mask) = makeSpriteMask(*(jobs[i]._sheet), jobs[i]._spriteid);
+  });
+
+  return true;
+}
+
+std::shared_ptr<const SpriteMask> AnimationFactory::getSpriteMask(
+  const std::string& spritesheetName, 
+  pxr::gfx::SpriteId_t spriteid)
+{
+  const SpritesheetSource* sheet = findSpritesheet(_spritesheetKeys, spritesheetName);
+  if(sheet == nullptr){
+    pxr::log::log(pxr::log::ERROR, msg_spritesheet_fail, spritesheetName);
+    return nullptr;
+  }
+
+  int spriteCount = getSpriteCount(*sheet);
+  if(spriteid < 0 || spriteid >= spriteCount){
+    pxr::log::log(pxr::log::ERROR, msg_invalid_spriteid, spritesheetName);
+    return nullptr;
+  }
+
+  auto& masks = _spriteMasks[spritesheetName];
+  if(masks.empty())
+    masks.resize(spriteCount);
+
+  auto& mask = masks[spriteid];
+  if(mask == nullptr)
+    mask = makeSpriteMask(*sheet, spriteid);
+
+  return mask;
+}
@@ -0,0 +1,264 @@
+#include <cassert>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pixiretro/pxr_log.h"
+#include "AssetPack.h"
+
+std::unique_ptr<AssetPack> AssetPack::instance {nullptr};
+
+//
+// log strings.
+//
+static constexpr const char* msg_no_pack = "no asset pack, loading assets from xml";
+static constexpr const char* msg_map_start = "mapping asset pack";
+static constexpr const char* msg_map_fail = "failed to map asset pack";
+static constexpr const char* msg_invalid_pack = "invalid asset pack or wrong version, loading assets from xml";
+static constexpr const char* msg_big_endian = "asset packs need a little endian host, loading assets from xml";
+static constexpr const char* msg_stale_pack = "asset pack source changed since packed, loading assets from xml";
+
+//
+// The size of a record of each section, in section order.
+//
+static constexpr uint32_t recordSizes[pack::SECTION_COUNT] {
+  1,
+  sizeof(pack::String),
+  sizeof(pack::Point),
+  sizeof(pack::SpeedPoint),
+  sizeof(uint32_t),
+  sizeof(pack::State),
+  sizeof(pack::PropDefinition),
+  sizeof(pack::LevelProp),
+  sizeof(pack::Level),
+  sizeof(pack::Source)
+};
+
+static bool isLittleEndian()
+{
+  uint32_t one {1};
+  uint8_t first {0};
+  std::memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+AssetPack::~AssetPack()
+{
+  if(_bytes != nullptr)
+    munmap(const_cast<uint8_t*>(_bytes), _size);
+}
+
+bool AssetPack::initialize()
+{
+  if(instance != nullptr)
+    return true;
+
+  std::string path {};
+  path += PACK_FILE_PATH;
+  path += PACK_FILE_NAME;
+  path += PACK_FILE_EXTENSION;
+
+  if(access(path.c_str(), F_OK) != 0){
+    pxr::log::log(pxr::log::INFO, msg_no_pack, path);
+    return false;
+  }
+
+  if(!isLittleEndian()){
+    pxr::log::log(pxr::log::WARN, msg_big_endian, path);
+    return false;
+  }
+
+  instance = std::unique_ptr<AssetPack>{new AssetPack()};
+  assert(instance != nullptr);
+  if(!instance->map(path) || !instance->validate(path) || !instance->isCurrent()){
+    instance.reset();
+    return false;
+  }
+
+  return true;
+}
+
+void AssetPack::shutdown()
+{
+  instance.reset();
+}
+
+bool AssetPack::isOpen()
+{
+  return instance != nullptr;
+}
+
+const char* AssetPack::getString(uint32_t index)
+{
+  uint32_t count {0};
+  const pack::String* strings = getRecords<pack::String>(pack::SECTION_STRINGS, &count);
+  assert(index < count);
+  const char* chars = getRecords<char>(pack::SECTION_CHARS);
+  return chars + strings[index]._offset;
+}
+
+int AssetPack::findLevel(const std::string& name)
+{
+  assert(instance != nullptr);
+  uint32_t count {0};
+  const pack::Level* levels = getRecords<pack::Level>(pack::SECTION_LEVELS, &count);
+  for(uint32_t i = 0; i < count; ++i)
+    if(name == getString(levels[i]._name))
+      return i;
+  return -1;
+}
+
+bool AssetPack::statFile(const std::string& path, uint32_t* size, uint64_t* mtime)
+{
+  assert(size != nullptr && mtime != nullptr);
+
+  struct stat info {};
+  if(stat(path.c_str(), &info) != 0)
+    return false;
+
+  *size = static_cast<uint32_t>(info.st_size);
+  *mtime = (static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000000000ull) + info.st_mtim.tv_nsec;
+  return true;
+}
+
+bool AssetPack::map(const std::string& path)
+{
+  pxr::log::log(pxr::log::INFO, msg_map_start, path);
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if(fd < 0){
+    pxr::log::log(pxr::log::ERROR, msg_map_fail, path);
+    return false;
+  }
+
+  struct stat info {};
+  if(fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(pack::Header))){
+    close(fd);
+    pxr::log::log(pxr::log::ERROR, msg_invalid_pack, path);
+    return false;
+  }
+
+  void* bytes = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(bytes == MAP_FAILED){
+    pxr::log::log(pxr::log::ERROR, msg_map_fail, path);
+    return false;
+  }
+
+  _bytes = static_cast<const uint8_t*>(bytes);
+  _size = info.st_size;
+  return true;
+}
+
+//
+// Checks the header and that every section, and every range and index within the records,
+// lies within the file; after this the records can be used without bounds checks.
+//
+bool AssetPack::validate(const std::string& path) const
+{
+  auto onerror = [&path](){
+    pxr::log::log(pxr::log::ERROR, msg_invalid_pack, path);
+    return false;
+  };
+
+  const pack::Header* header = reinterpret_cast<const pack::Header*>(_bytes);
+  if(std::memcmp(header->_magic, pack::magic, sizeof(pack::magic)) != 0 || header->_version != pack::version)
+    return onerror();
+
+  uint32_t counts[pack::SECTION_COUNT] {};
+  for(int s = 0; s < pack::SECTION_COUNT; ++s){
+    const pack::Range& section = header->_sections[s];
+    uint64_t end = section._first + (static_cast<uint64_t>(section._count) * recordSizes[s]);
+    if((section._first % 4) != 0 || end > _size)
+      return onerror();
+    counts[s] = section._count;
+  }
+
+  auto isInRange = [](const pack::Range& range, uint32_t count){
+    return static_cast<uint64_t>(range._first) + range._count <= count;
+  };
+
+  const char* chars = reinterpret_cast<const char*>(_bytes + header->_sections[pack::SECTION_CHARS]._first);
+  const pack::String* strings = reinterpret_cast<const pack::String*>(_bytes + header->_sections[pack::SECTION_STRINGS]._first);
+  for(uint32_t i = 0; i < counts[pack::SECTION_STRINGS]; ++i){
+    uint64_t end = static_cast<uint64_t>(strings[i]._offset) + strings[i]._length;
+    if(end >= counts[pack::SECTION_CHARS] || chars[end] != '\0')
+      return onerror();
+  }
+
+  const uint32_t* soundNames = reinterpret_cast<const uint32_t*>(_bytes + header->_sections[pack::SECTION_SOUND_NAMES]._first);
+  for(uint32_t i = 0; i < counts[pack::SECTION_SOUND_NAMES]; ++i)
+    if(soundNames[i] >= counts[pack::SECTION_STRINGS])
+      return onerror();
+
+  const pack::State* states = reinterpret_cast<const pack::State*>(_bytes + header->_sections[pack::SECTION_STATES]._first);
+  for(uint32_t i = 0; i < counts[pack::SECTION_STATES]; ++i){
+    const pack::State& state = states[i];
+    if(!isInRange(state._positions, counts[pack::SECTION_POINTS]) || state._positions._count == 0 ||
+       !isInRange(state._speeds, counts[pack::SECTION_SPEED_POINTS]) || state._speeds._count == 0 ||
+       !isInRange(state._sounds, counts[pack::SECTION_SOUND_NAMES]) ||
+       state._animationName >= counts[pack::SECTION_STRINGS])
+    {
+      return onerror();
+    }
+  }
+
+  const pack::PropDefinition* defs = reinterpret_cast<const pack::PropDefinition*>(_bytes + header->_sections[pack::SECTION_PROP_DEFINITIONS]._first);
+  for(uint32_t i = 0; i < counts[pack::SECTION_PROP_DEFINITIONS]; ++i){
+    if(defs[i]._name >= counts[pack::SECTION_STRINGS] || defs[i]._stateTransitionMode > 1 ||
+       !isInRange(defs[i]._states, counts[pack::SECTION_STATES]) || defs[i]._states._count == 0)
+    {
+      return onerror();
+    }
+  }
+
+  const pack::LevelProp* levelProps = reinterpret_cast<const pack::LevelProp*>(_bytes + header->_sections[pack::SECTION_LEVEL_PROPS]._first);
+  for(uint32_t i = 0; i < counts[pack::SECTION_LEVEL_PROPS]; ++i)
+    if(levelProps[i]._definition >= counts[pack::SECTION_PROP_DEFINITIONS])
+      return onerror();
+
+  const pack::Level* levels = reinterpret_cast<const pack::Level*>(_bytes + header->_sections[pack::SECTION_LEVELS]._first);
+  for(uint32_t i = 0; i < counts[pack::SECTION_LEVELS]; ++i)
+    if(levels[i]._name >= counts[pack::SECTION_STRINGS] || !isInRange(levels[i]._props, counts[pack::SECTION_LEVEL_PROPS]))
+      return onerror();
+
+  const pack::Source* sources = reinterpret_cast<const pack::Source*>(_bytes + header->_sections[pack::SECTION_SOURCES]._first);
+  for(uint32_t i = 0; i < counts[pack::SECTION_SOURCES]; ++i)
+    if(sources[i]._path >= counts[pack::SECTION_STRINGS])
+      return onerror();
+
+  return true;
+}
+
+//
+// Only stats the sources, it does not read them, so checking costs a syscall per source
+// file. An edit which keeps both the size and the modification time is not noticed; a touch
+// or checkout which changes only the time makes the pack stale, which is the safe side.
+//
+bool AssetPack::isCurrent() const
+{
+  uint32_t count {0};
+  const pack::Source* sources = static_cast<const pack::Source*>(getSection(pack::SECTION_SOURCES, &count));
+  for(uint32_t i = 0; i < count; ++i){
+    const char* path = getString(sources[i]._path);
+    uint32_t size {0};
+    uint64_t mtime {0};
+    uint64_t packedMtime = (static_cast<uint64_t>(sources[i]._mtimeHigh) << 32) | sources[i]._mtimeLow;
+    if(!statFile(path, &size, &mtime) || size != sources[i]._size || mtime != packedMtime){
+      pxr::log::log(pxr::log::WARN, msg_stale_pack, path);
+      return false;
+    }
+  }
+  return true;
+}
+
+const void* AssetPack::getSection(pack::Section section, uint32_t* count) const
+{
+  assert(_bytes != nullptr);
+  assert(0 <= section && section < pack::SECTION_COUNT);
+  const pack::Header* header = reinterpret_cast<const pack::Header*>(_bytes);
+  if(count != nullptr)
+    *count = header->_sections[section]._count;
+  return _bytes + header->_sections[section]._first;
+}
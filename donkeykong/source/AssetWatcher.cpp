@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cassert>
+#include "pixiretro/pxr_log.h"
+#include "AssetWatcher.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+std::unique_ptr<AssetWatcher> AssetWatcher::instance {nullptr};
+
+//
+// log strings.
+//
+static constexpr const char* msg_watch_start = "watching for asset changes";
+static constexpr const char* msg_watch_fail = "failed to watch for asset changes";
+static constexpr const char* msg_unsupported = "watching for asset changes is only supported on linux";
+
+AssetWatcher::~AssetWatcher()
+{
+#ifdef __linux__
+  if(_fd >= 0)
+    close(_fd);
+#endif
+}
+
+bool AssetWatcher::initialize()
+{
+  if(instance != nullptr)
+    return true;
+
+#ifdef __linux__
+  instance = std::unique_ptr<AssetWatcher>{new AssetWatcher()};
+  assert(instance != nullptr);
+
+  instance->_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if(instance->_fd < 0){
+    pxr::log::log(pxr::log::ERROR, msg_watch_fail);
+    instance.reset();
+    return false;
+  }
+
+  //
+  // editors either write files in place or write a temporary and rename it over the file.
+  //
+  for(const char* path : WATCHED_PATHS){
+    int watch = inotify_add_watch(instance->_fd, path, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if(watch < 0){
+      pxr::log::log(pxr::log::ERROR, msg_watch_fail, path);
+      instance.reset();
+      return false;
+    }
+    instance->_watches.push_back(watch);
+    pxr::log::log(pxr::log::INFO, msg_watch_start, path);
+  }
+
+  return true;
+#else
+  pxr::log::log(pxr::log::WARN, msg_unsupported);
+  return false;
+#endif
+}
+
+void AssetWatcher::shutdown()
+{
+  instance.reset();
+}
+
+std::vector<std::string> AssetWatcher::poll()
+{
+  std::vector<std::string> paths {};
+
+#ifdef __linux__
+  if(instance == nullptr)
+    return paths;
+
+  alignas(struct inotify_event) char buffer[4096];
+  while(true){
+    ssize_t size = read(instance->_fd, buffer, sizeof(buffer));
+    if(size <= 0)
+      break;
+
+    for(ssize_t offset = 0; offset < size;){
+      const auto* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+      offset += sizeof(struct inotify_event) + event->len;
+
+      if(event->len == 0 || (event->mask & IN_ISDIR))
+        continue;
+
+      auto watch = std::find(instance->_watches.begin(), instance->_watches.end(), event->wd);
+      if(watch == instance->_watches.end())
+        continue;
+
+      std::string path {WATCHED_PATHS[watch - instance->_watches.begin()]};
+      path += event->name;
+      if(std::find(paths.begin(), paths.end(), path) == paths.end())
+        paths.push_back(std::move(path));
+    }
+  }
+#endif
+
+  return paths;
+}
@@ -0,0 +1,69 @@
+#include "DirtyRects.h"
+
+static bool isIntersection(const pxr::iRect& a, const pxr::iRect& b)
+{
+  return a._x < b._x + b._w && b._x < a._x + a._w && a._y < b._y + b._h && b._y < a._y + a._h;
+}
+
+DirtyRects::DirtyRects() :
+  _lastCommands{},
+  _clearRects{},
+  _redraws{},
+  _isInvalid{true}
+{}
+
+bool DirtyRects::update(const std::vector<DrawCommand>& commands)
+{
+  _clearRects.clear();
+  _redraws.assign(commands.size(), false);
+
+  if(_isInvalid || commands.size() != _lastCommands.size()){
+    _lastCommands = commands;
+    _isInvalid = false;
+    return false;
+  }
+
+  int count = commands.size();
+  for(int i = 0; i < count; ++i){
+    if(commands[i] == _lastCommands[i])
+      continue;
+    _redraws[i] = true;
+    addClearRect(_lastCommands[i]._bounds);
+    addClearRect(commands[i]._bounds);
+  }
+
+  //
+  // spread the dirty region to every command it touches, until it stops growing; rects
+  // are only ever appended so each pass need only test the rects added since the last.
+  //
+  size_t tested {0};
+  while(tested < _clearRects.size()){
+    size_t end = _clearRects.size();
+    for(int i = 0; i < count; ++i){
+      if(_redraws[i])
+        continue;
+      for(size_t r = tested; r < end; ++r){
+        if(isIntersection(commands[i]._bounds, _clearRects[r])){
+          _redraws[i] = true;
+          addClearRect(commands[i]._bounds);
+          break;
+        }
+      }
+    }
+    tested = end;
+  }
+
+  _lastCommands = commands;
+  return true;
+}
+
+void DirtyRects::invalidate()
+{
+  _isInvalid = true;
+}
+
+void DirtyRects::addClearRect(const pxr::iRect& rect)
+{
+  if(rect._w > 0 && rect._h > 0)
+    _clearRects.push_back(rect);
+}
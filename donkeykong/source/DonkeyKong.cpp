@@ -1,22 +1,50 @@
 #include "DonkeyKong.h"
+#include "AssetPack.h"
 #include "AnimationFactory.h"
 #include "PropFactory.h"
 #include "MarioFactory.h"
+#include "ResourceCache.h"
+#include "InputReplay.h"
+#include "Profiler.h"
+#include "Trace.h"
 #include "PlayState.h"
 #include "Defines.h"
 
+DonkeyKong::DonkeyKong(InputReplay::Mode replayMode, std::string replayName) :
+  _replayMode{replayMode},
+  _replayName{std::move(replayName)}
+{}
+
 bool DonkeyKong::onInit()
 {
-  if(!AnimationFactory::initialize())
-    return false;
+  Trace::initialize();
 
-  if(!PropFactory::initialize())
-    return false;
+  {
+    TraceScope scope {"AssetPack::initialize"};
+    AssetPack::initialize();
+  }
 
-  if(!MarioFactory::initialize())
-    return false;
+  ResourceCache::initialize();
+
+  {
+    TraceScope scope {"AnimationFactory::initialize"};
+    if(!AnimationFactory::initialize())
+      return false;
+  }
 
-  _active = std::shared_ptr<pxr::AppState>(new PlayState(this));
+  {
+    TraceScope scope {"PropFactory::initialize"};
+    if(!PropFactory::initialize())
+      return false;
+  }
+
+  {
+    TraceScope scope {"MarioFactory::initialize"};
+    if(!MarioFactory::initialize())
+      return false;
+  }
+
+  _active = std::shared_ptr<pxr::AppState>(new PlayState(this, _replayMode, _replayName));
 
   if(!_active->onInit())
     return false;
@@ -30,7 +58,21 @@ bool DonkeyKong::onInit()
 
 void DonkeyKong::onShutdown()
 {
+  Profiler::logReport();
+  ResourceCache::logReport();
+
+  //
+  // the play state preloads levels on a thread which uses the factories.
+  //
+  auto search = _states.find(PlayState::name);
+  if(search != _states.end())
+    static_cast<PlayState*>(search->second.get())->onShutdown();
+
+  Trace::shutdown();
   PropFactory::shutdown();
   AnimationFactory::shutdown();
   MarioFactory::shutdown();
+  ResourceCache::shutdown();
+  AssetPack::shutdown();
+  InputReplay::shutdown();
 }
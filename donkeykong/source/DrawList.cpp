@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cassert>
+#include "DrawList.h"
+
+bool operator==(const DrawCommand& a, const DrawCommand& b)
+{
+  return a._layer == b._layer && 
+         a._spritesheetKey == b._spritesheetKey && 
+         a._spriteid == b._spriteid &&
+         a._position._x == b._position._x && 
+         a._position._y == b._position._y &&
+         a._mirrorX == b._mirrorX && 
+         a._mirrorY == b._mirrorY;
+}
+
+bool operator!=(const DrawCommand& a, const DrawCommand& b)
+{
+  return !(a == b);
+}
+
+DrawList::DrawList() :
+  _commands{},
+  _sortKeys{},
+  _runCount{0},
+  _cullRect{},
+  _isCulling{false},
+  _culledCount{0}
+{}
+
+void DrawList::clear()
+{
+  _commands.clear();
+  _sortKeys.clear();
+  _culledCount = 0;
+}
+
+void DrawList::setCullRect(const pxr::iRect& rect)
+{
+  _cullRect = rect;
+  _isCulling = true;
+}
+
+void DrawList::disableCulling()
+{
+  _isCulling = false;
+}
+
+void DrawList::push(const DrawCommand& command)
+{
+  assert(bottomLayer <= command._layer && command._layer <= topLayer);
+
+  if(_isCulling){
+    const pxr::iRect& b = command._bounds;
+    if(b._x >= _cullRect._x + _cullRect._w || b._x + b._w <= _cullRect._x ||
+       b._y >= _cullRect._y + _cullRect._h || b._y + b._h <= _cullRect._y)
+    {
+      ++_culledCount;
+      return;
+    }
+  }
+
+  //
+  // spritesheets with keys equal in the low 16 bits share a group, which only costs an
+  // extra run, never the draw order of layers.
+  //
+  uint64_t layer = static_cast<uint64_t>(command._layer - bottomLayer);
+  uint64_t spritesheet = static_cast<uint64_t>(command._spritesheetKey) & 0xffff;
+  uint64_t order = _commands.size();
+  _sortKeys.push_back((layer << 48) | (spritesheet << 32) | order);
+  _commands.push_back(command);
+}
+
+void DrawList::submit(RenderBuffer& renderBuffer, int screenid)
+{
+  static const std::vector<bool> none {};
+  submit(renderBuffer, screenid, none);
+}
+
+void DrawList::submit(RenderBuffer& renderBuffer, int screenid, const std::vector<bool>& isSelected)
+{
+  assert(isSelected.empty() || isSelected.size() == _commands.size());
+
+  std::sort(_sortKeys.begin(), _sortKeys.end());
+
+  _runCount = 0;
+  pxr::gfx::ResourceKey_t runSpritesheetKey {0};
+  for(uint64_t key : _sortKeys){
+    uint64_t index = key & 0xffffffff;
+    if(!isSelected.empty() && !isSelected[index])
+      continue;
+    const DrawCommand& command = _commands[index];
+    if(_runCount == 0 || command._spritesheetKey != runSpritesheetKey){
+      runSpritesheetKey = command._spritesheetKey;
+      ++_runCount;
+    }
+    renderBuffer.drawSprite(command._position, command._spritesheetKey, command._spriteid, screenid,
+                            command._mirrorX, command._mirrorY);
+  }
+}
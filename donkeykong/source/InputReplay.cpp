@@ -0,0 +1,286 @@
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include "pixiretro/pxr_log.h"
+#include "InputReplay.h"
+#include "Random.h"
+
+std::unique_ptr<InputReplay> InputReplay::instance {nullptr};
+
+//
+// log strings.
+//
+static constexpr const char* msg_record_start = "recording input replay";
+static constexpr const char* msg_playback_start = "playing back input replay";
+static constexpr const char* msg_playback_over = "input replay playback finished";
+static constexpr const char* msg_open_fail = "failed to open input replay file";
+static constexpr const char* msg_not_replay = "file is not an input replay or wrong version";
+static constexpr const char* msg_key_mismatch = "input replay was recorded with different keys";
+static constexpr const char* msg_write_fail = "failed writing input replay file";
+
+static constexpr char magic[4] {'D', 'K', 'R', 'P'};
+static constexpr uint8_t version {2};
+
+static void writeU32(std::fstream& file, uint32_t value)
+{
+  char bytes[4] {
+    static_cast<char>(value & 0xff),
+    static_cast<char>((value >> 8) & 0xff),
+    static_cast<char>((value >> 16) & 0xff),
+    static_cast<char>((value >> 24) & 0xff)
+  };
+  file.write(bytes, sizeof(bytes));
+}
+
+static void writeU64(std::fstream& file, uint64_t value)
+{
+  writeU32(file, static_cast<uint32_t>(value & 0xffffffff));
+  writeU32(file, static_cast<uint32_t>(value >> 32));
+}
+
+static bool readU32(std::fstream& file, uint32_t& value)
+{
+  unsigned char bytes[4];
+  if(!file.read(reinterpret_cast<char*>(bytes), sizeof(bytes)))
+    return false;
+  value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+  return true;
+}
+
+static bool readU64(std::fstream& file, uint64_t& value)
+{
+  uint32_t low {0}, high {0};
+  if(!readU32(file, low) || !readU32(file, high))
+    return false;
+  value = low | (static_cast<uint64_t>(high) << 32);
+  return true;
+}
+
+bool InputReplay::initialize(Mode mode, const std::string& name, const std::vector<pxr::input::KeyCode>& keys)
+{
+  assert(keys.size() <= maxKeyCount);
+
+  if(mode == MODE_LIVE)
+    return true;
+
+  instance = std::unique_ptr<InputReplay>{new InputReplay()};
+  assert(instance != nullptr);
+
+  instance->_mode = mode;
+  instance->_keys = keys;
+  instance->_keysDown = 0;
+  instance->_keysPressed = 0;
+  instance->_lastDt = 0.f;
+  instance->_isPlaybackOver = false;
+
+  std::string path {};
+  path += RESOURCE_PATH_REPLAYS;
+  path += name;
+  path += REPLAY_FILE_EXTENSION;
+
+  bool success = mode == MODE_RECORD ? instance->openForRecord(path) : instance->openForPlayback(path);
+  if(!success)
+    instance.reset();
+
+  return success;
+}
+
+void InputReplay::shutdown()
+{
+  if(instance == nullptr)
+    return;
+
+  if(instance->_mode == MODE_RECORD){
+    instance->_file.flush();
+    if(!instance->_file)
+      pxr::log::log(pxr::log::ERROR, msg_write_fail, instance->_path);
+  }
+
+  instance.reset();
+}
+
+float InputReplay::onTick(float dt)
+{
+  if(instance == nullptr)
+    return dt;
+
+  if(instance->_mode == MODE_RECORD)
+    instance->recordTick(dt);
+
+  else if(instance->_mode == MODE_PLAYBACK && !instance->_isPlaybackOver){
+    if(!instance->playbackTick(dt)){
+      instance->_isPlaybackOver = true;
+      instance->_keysDown = 0;
+      instance->_keysPressed = 0;
+      pxr::log::log(pxr::log::INFO, msg_playback_over, instance->_path);
+    }
+  }
+
+  return dt;
+}
+
+bool InputReplay::isKeyDown(pxr::input::KeyCode key)
+{
+  if(instance == nullptr || instance->_mode != MODE_PLAYBACK)
+    return pxr::input::isKeyDown(key);
+
+  int k = instance->findKey(key);
+  return k < 0 ? pxr::input::isKeyDown(key) : (instance->_keysDown >> k) & 1;
+}
+
+bool InputReplay::isKeyPressed(pxr::input::KeyCode key)
+{
+  if(instance == nullptr || instance->_mode != MODE_PLAYBACK)
+    return pxr::input::isKeyPressed(key);
+
+  int k = instance->findKey(key);
+  return k < 0 ? pxr::input::isKeyPressed(key) : (instance->_keysPressed >> k) & 1;
+}
+
+InputReplay::Mode InputReplay::getMode()
+{
+  return instance == nullptr ? MODE_LIVE : instance->_mode;
+}
+
+bool InputReplay::isPlaybackOver()
+{
+  return instance != nullptr && instance->_isPlaybackOver;
+}
+
+bool InputReplay::openForRecord(const std::string& path)
+{
+  pxr::log::log(pxr::log::INFO, msg_record_start, path);
+
+  std::error_code error {};
+  std::filesystem::create_directories(RESOURCE_PATH_REPLAYS, error);
+
+  _path = path;
+  _file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if(!_file){
+    pxr::log::log(pxr::log::ERROR, msg_open_fail, path);
+    return false;
+  }
+
+  _file.write(magic, sizeof(magic));
+  _file.put(static_cast<char>(version));
+  _file.put(static_cast<char>(_keys.size()));
+  for(auto key : _keys)
+    writeU32(_file, static_cast<uint32_t>(key));
+
+  uint64_t seed = Random::makeSeed();
+  Random::seed(seed);
+  writeU64(_file, seed);
+
+  return true;
+}
+
+bool InputReplay::openForPlayback(const std::string& path)
+{
+  pxr::log::log(pxr::log::INFO, msg_playback_start, path);
+
+  _path = path;
+  _file.open(path, std::ios::in | std::ios::binary);
+  if(!_file){
+    pxr::log::log(pxr::log::ERROR, msg_open_fail, path);
+    return false;
+  }
+
+  char fileMagic[4] {};
+  _file.read(fileMagic, sizeof(fileMagic));
+  int fileVersion = _file.get();
+  int keyCount = _file.get();
+  if(!_file || std::memcmp(fileMagic, magic, sizeof(magic)) != 0 || fileVersion != version){
+    pxr::log::log(pxr::log::ERROR, msg_not_replay, path);
+    return false;
+  }
+
+  if(keyCount != static_cast<int>(_keys.size())){
+    pxr::log::log(pxr::log::ERROR, msg_key_mismatch, path);
+    return false;
+  }
+
+  for(auto key : _keys){
+    uint32_t fileKey {0};
+    if(!readU32(_file, fileKey) || fileKey != static_cast<uint32_t>(key)){
+      pxr::log::log(pxr::log::ERROR, msg_key_mismatch, path);
+      return false;
+    }
+  }
+
+  uint64_t seed {0};
+  if(!readU64(_file, seed)){
+    pxr::log::log(pxr::log::ERROR, msg_not_replay, path);
+    return false;
+  }
+  Random::seed(seed);
+
+  return true;
+}
+
+void InputReplay::recordTick(float dt)
+{
+  int keyCount = _keys.size();
+
+  uint64_t bits {0};
+  for(int k = 0; k < keyCount; ++k){
+    bits |= static_cast<uint64_t>(pxr::input::isKeyDown(_keys[k])) << k;
+    bits |= static_cast<uint64_t>(pxr::input::isKeyPressed(_keys[k])) << (keyCount + k);
+  }
+
+  bool isDtChanged = dt != _lastDt;
+  bits |= static_cast<uint64_t>(isDtChanged) << (2 * keyCount);
+
+  char bytes[8];
+  int byteCount = getBytesPerTick();
+  for(int b = 0; b < byteCount; ++b)
+    bytes[b] = static_cast<char>((bits >> (8 * b)) & 0xff);
+  _file.write(bytes, byteCount);
+
+  if(isDtChanged){
+    uint32_t dtBits;
+    std::memcpy(&dtBits, &dt, sizeof(dtBits));
+    writeU32(_file, dtBits);
+    _lastDt = dt;
+  }
+}
+
+bool InputReplay::playbackTick(float& dt)
+{
+  int keyCount = _keys.size();
+
+  unsigned char bytes[8];
+  int byteCount = getBytesPerTick();
+  if(!_file.read(reinterpret_cast<char*>(bytes), byteCount))
+    return false;
+
+  uint64_t bits {0};
+  for(int b = 0; b < byteCount; ++b)
+    bits |= static_cast<uint64_t>(bytes[b]) << (8 * b);
+
+  uint32_t keyMask = (uint32_t{1} << keyCount) - 1;
+  _keysDown = bits & keyMask;
+  _keysPressed = (bits >> keyCount) & keyMask;
+
+  if((bits >> (2 * keyCount)) & 1){
+    uint32_t dtBits {0};
+    if(!readU32(_file, dtBits))
+      return false;
+    std::memcpy(&_lastDt, &dtBits, sizeof(dtBits));
+  }
+
+  dt = _lastDt;
+  return true;
+}
+
+int InputReplay::findKey(pxr::input::KeyCode key) const
+{
+  for(int k = 0; k < static_cast<int>(_keys.size()); ++k)
+    if(_keys[k] == key)
+      return k;
+  return -1;
+}
+
+int InputReplay::getBytesPerTick() const
+{
+  return ((2 * _keys.size()) + 1 + 7) / 8;
+}
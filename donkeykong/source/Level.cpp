@@ -6,10 +6,17 @@
 #include "pixiretro/pxr_xml.h"
 #include "pixiretro/pxr_log.h"
 #include "pixiretro/pxr_collision.h"
+#include "AABBKernel.h"
+#include "AssetPack.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "DirtyRects.h"
+#include "SpriteMask.h"
 #include "PropFactory.h"
 #include "Prop.h"
 #include "MarioFactory.h"
 #include "PlayState.h"
+#include "Defines.h"
 #include "Level.h"
 
 using namespace tinyxml2;
@@ -18,38 +25,161 @@ using namespace tinyxml2;
 // log strings.
 //
 static constexpr const char* msg_load_level = "loading level";
+static constexpr const char* msg_load_level_packed = "loading level from asset pack";
 static constexpr const char* msg_load_success = "success loading level";
 static constexpr const char* msg_load_abort = "aborting level load due to error";
+static constexpr const char* msg_parsing_xml = "parsing xml asset file";
+static constexpr const char* msg_parse_error = "parsing error in xml file";
+static constexpr const char* msg_read_attribute_fail = "failed to read xml attribute";
+static constexpr const char* msg_find_element_fail = "failed to find xml element";
+static constexpr const char* msg_tinyxml2_error_desc = "tinyxml2 error desc";
+static constexpr const char* msg_missing_prop = "missing prop definition";
+
+//
+// Logs a message of a parse, or appends it to the caller's buffer if it has one.
+//
+static void report(std::vector<Level::LogMessage>* messages, pxr::log::Level level, const char* msg,
+                   const std::string& addendum = std::string{})
+{
+  if(messages == nullptr)
+    pxr::log::log(level, msg, addendum);
+  else
+    messages->push_back(Level::LogMessage{level, msg, addendum});
+}
+
+//
+// The engine's xml helpers (pxr::io) log whatever the outcome, so level files, which may be
+// parsed on the loader thread, are read with these instead; they report like the engine's.
+//
+static bool readXmlDocument(XMLDocument* doc, const std::string& xmlpath,
+                            std::vector<Level::LogMessage>* messages)
+{
+  report(messages, pxr::log::INFO, msg_parsing_xml, xmlpath);
+  doc->LoadFile(xmlpath.c_str());
+  if(doc->Error()){
+    report(messages, pxr::log::ERROR, msg_parse_error, xmlpath);
+    report(messages, pxr::log::ERROR, msg_tinyxml2_error_desc, doc->ErrorStr());
+    return false;
+  }
+  return true;
+}
+
+static bool readChildElement(XMLNode* parent, XMLElement** child, const char* childname,
+                             std::vector<Level::LogMessage>* messages)
+{
+  *child = parent->FirstChildElement(childname);
+  if(*child == nullptr){
+    report(messages, pxr::log::ERROR, msg_find_element_fail, childname);
+    return false;
+  }
+  return true;
+}
+
+static bool readFloatAttribute(XMLElement* element, const char* attribute, float* value,
+                               std::vector<Level::LogMessage>* messages)
+{
+  if(element->QueryFloatAttribute(attribute, value) != XML_SUCCESS){
+    report(messages, pxr::log::ERROR, msg_read_attribute_fail, attribute);
+    return false;
+  }
+  return true;
+}
+
+static bool readStringAttribute(XMLElement* element, const char* attribute, const char** value,
+                                std::vector<Level::LogMessage>* messages)
+{
+  if(element->QueryStringAttribute(attribute, value) != XML_SUCCESS){
+    report(messages, pxr::log::ERROR, msg_read_attribute_fail, attribute);
+    return false;
+  }
+  return true;
+}
 
 Level::Level() :
   _state{STATE_UNLOADED},
   _ending{ENDING_NONE},
   _controlScheme{nullptr},
   _props{},
+  _propHotData{new PropHotData{}},
+  _propSnapshots{},
+  _propHotDataSnapshot{},
+  _propGrid{},
+  _movingProps{},
+  _propCandidates{},
+  _propHits{},
   _marioSpawnPosition{0.f, 0.f},
   _mario{nullptr},
   _propInteractions{},
+  _drawList{},
+  _backgroundProps{},
+  _foregroundProps{},
+  _backgroundScreenid{-1},
+  _isBackgroundDirty{true},
+  _renderMode{RENDER_FULL},
+  _dirtyRects{},
+  _drawnCount{0},
+  _culledCount{0},
+  _debugFontKey{-1},
   _isDebugDraw{false}
-{}
+{
+  pxr::iRect viewport {};
+  viewport._x = 0;
+  viewport._y = 0;
+  viewport._w = worldSize._x;
+  viewport._h = worldSize._y;
+  _drawList.setCullRect(viewport);
+}
 
 bool Level::load(const std::string& file)
 {
   assert(_state == STATE_UNLOADED);
 
+  TraceScope scope {"Level::load"};
+
+  Layout layout {};
+  if(!parse(file, &layout))
+    return false;
+
+  build(layout);
+
+  pxr::log::log(pxr::log::INFO, msg_load_success, file);
+
+  return true;
+}
+
+bool Level::parse(const std::string& file, Layout* layout, std::vector<LogMessage>* messages)
+{
+  assert(layout != nullptr);
+
+  TraceScope scope {"Level::parse"};
+
+  if(AssetPack::isOpen()){
+    int packIndex = AssetPack::findLevel(file);
+    if(packIndex >= 0)
+      return parsePacked(packIndex, layout, messages);
+  }
+
+  return parseXml(file, layout, messages);
+}
+
+bool Level::parseXml(const std::string& file, Layout* layout, std::vector<LogMessage>* messages)
+{
+  assert(layout != nullptr);
+
   std::string xmlpath {};
   xmlpath += RESOURCE_PATH_LEVEL;
   xmlpath += file;
   xmlpath += pxr::io::XML_FILE_EXTENSION;
 
-  pxr::log::log(pxr::log::INFO, msg_load_level, xmlpath);
+  report(messages, pxr::log::INFO, msg_load_level, xmlpath);
 
-  auto onerror = [](){
-    pxr::log::log(pxr::log::INFO, msg_load_level);
+  auto onerror = [messages](){
+    report(messages, pxr::log::ERROR, msg_load_abort);
     return false;
   };
 
   XMLDocument doc {};
-  if(!pxr::io::parseXmlDocument(&doc, xmlpath))
+  if(!readXmlDocument(&doc, xmlpath, messages))
     return onerror();
 
   XMLElement* xmllevel {nullptr};
@@ -57,56 +187,194 @@ bool Level::load(const std::string& file)
   XMLElement* xmlprops {nullptr};
   XMLElement* xmlprop {nullptr};
 
-  if(!pxr::io::extractChildElement(&doc, &xmllevel, "level"))
+  if(!readChildElement(&doc, &xmllevel, "level", messages))
     return onerror();
 
-  if(!pxr::io::extractChildElement(xmllevel, &xmlmariospawn, "marioSpawn"))
+  if(!readChildElement(xmllevel, &xmlmariospawn, "marioSpawn", messages))
     return onerror();
     
-  if(!pxr::io::extractFloatAttribute(xmlmariospawn, "x", &_marioSpawnPosition._x)) return onerror();
-  if(!pxr::io::extractFloatAttribute(xmlmariospawn, "y", &_marioSpawnPosition._y)) return onerror();
+  if(!readFloatAttribute(xmlmariospawn, "x", &layout->_marioSpawnPosition._x, messages)) return onerror();
+  if(!readFloatAttribute(xmlmariospawn, "y", &layout->_marioSpawnPosition._y, messages)) return onerror();
   
-  if(!pxr::io::extractChildElement(xmllevel, &xmlprops, "props"))
+  if(!readChildElement(xmllevel, &xmlprops, "props", messages))
     return onerror();
 
-  if(!pxr::io::extractChildElement(xmlprops, &xmlprop, "prop"))
+  if(!readChildElement(xmlprops, &xmlprop, "prop", messages))
     return onerror();
 
   do {
     const char* propName {nullptr};
-    if(!pxr::io::extractStringAttribute(xmlprop, "name", &propName)) return onerror();
+    if(!readStringAttribute(xmlprop, "name", &propName, messages)) return onerror();
+
+    int definition = PropFactory::findDefinition(propName);
+    if(definition < 0){
+      report(messages, pxr::log::ERROR, msg_missing_prop, propName);
+      return onerror();
+    }
 
     pxr::Vector2f position {};
-    if(!pxr::io::extractFloatAttribute(xmlprop, "x", &position._x)) return onerror();
-    if(!pxr::io::extractFloatAttribute(xmlprop, "y", &position._y)) return onerror();
+    if(!readFloatAttribute(xmlprop, "x", &position._x, messages)) return onerror();
+    if(!readFloatAttribute(xmlprop, "y", &position._y, messages)) return onerror();
 
-    _props.emplace_back(std::move(PropFactory::makeProp(position, propName)));
+    layout->_props.push_back(PropPlacement{definition, position});
 
     xmlprop = xmlprop->NextSiblingElement("prop");
   }
   while(xmlprop != 0);
 
-  auto compare = [](const Prop& p0, const Prop& p1){
-    return p0.getDrawLayer() < p1.getDrawLayer();
-  };
+  return true;
+}
+
+bool Level::parsePacked(int packIndex, Layout* layout, std::vector<LogMessage>* messages)
+{
+  const pack::Level& level = AssetPack::getRecords<pack::Level>(pack::SECTION_LEVELS)[packIndex];
+  const pack::LevelProp* props = AssetPack::getRecords<pack::LevelProp>(pack::SECTION_LEVEL_PROPS);
+
+  report(messages, pxr::log::INFO, msg_load_level_packed, AssetPack::getString(level._name));
+
+  layout->_marioSpawnPosition._x = level._marioSpawnX;
+  layout->_marioSpawnPosition._y = level._marioSpawnY;
+
+  layout->_props.reserve(level._props._count);
+  for(uint32_t p = level._props._first; p < level._props._first + level._props._count; ++p){
+    pxr::Vector2f position {props[p]._x, props[p]._y};
+    layout->_props.push_back(PropPlacement{static_cast<int>(props[p]._definition), position});
+  }
+
+  return true;
+}
+
+void Level::logMessages(const std::vector<LogMessage>& messages)
+{
+  for(const auto& message : messages)
+    pxr::log::log(message._level, message._msg, message._addendum);
+}
+
+void Level::build(const Layout& layout)
+{
+  assert(_state == STATE_UNLOADED);
+
+  TraceScope scope {"Level::build"};
+
+  _marioSpawnPosition = layout._marioSpawnPosition;
 
+  _props.reserve(layout._props.size());
+  for(const auto& placement : layout._props)
+    _props.emplace_back(PropFactory::makeProp(placement._position, placement._definition));
+
+  onPropsLoaded();
+}
+
+static bool isDrawnBefore(const Prop& p0, const Prop& p1)
+{
+  return p0.getDrawLayer() < p1.getDrawLayer();
+}
+
+void Level::onPropsLoaded()
+{
+  indexProps();
+
+  _isBackgroundDirty = true;
+
+  _state = STATE_UNINITIALIZED;
+}
+
+void Level::indexProps()
+{
   //
   // sort in ascending order of draw layer so we draw in the correct order.
   //
-  std::sort(_props.begin(), _props.end(), compare);
+  std::sort(_props.begin(), _props.end(), isDrawnBefore);
 
-  _state = STATE_UNINITIALIZED;
+  //
+  // must be done post sort since the hot data and grid reference props by index.
+  //
+  for(int i = 0; i < static_cast<int>(_props.size()); ++i){
+    _props[i].bindHotData(_propHotData.get(), _propHotData->add());
+    _propGrid.insert(i, getHotInteractionBox(i));
+    if(!_props[i].isStatic())
+      _movingProps.push_back(i);
+  }
 
-  pxr::log::log(pxr::log::INFO, msg_load_success, xmlpath);
+  classifyProps();
+}
 
-  return true;
+void Level::classifyProps()
+{
+  _backgroundProps.clear();
+  _foregroundProps.clear();
+
+  int minDynamicLayer {DrawList::topLayer};
+  for(const auto& prop : _props)
+    if(!prop.isStaticDraw())
+      minDynamicLayer = std::min(minDynamicLayer, prop.getDrawLayer());
+
+  for(int i = 0; i < static_cast<int>(_props.size()); ++i){
+    if(_props[i].isStaticDraw() && _props[i].getDrawLayer() <= minDynamicLayer)
+      _backgroundProps.push_back(i);
+    else
+      _foregroundProps.push_back(i);
+  }
+}
+
+void Level::onPropDefinitionsChanged()
+{
+  assert(_state != STATE_UNLOADED);
+
+  TraceScope scope {"Level::onPropDefinitionsChanged"};
+
+  for(auto& prop : _props)
+    prop.redefine();
+
+  if(std::is_sorted(_props.begin(), _props.end(), isDrawnBefore)){
+    _movingProps.clear();
+    for(int i = 0; i < static_cast<int>(_props.size()); ++i){
+      _propGrid.update(i, getHotInteractionBox(i));
+      if(!_props[i].isStatic())
+        _movingProps.push_back(i);
+    }
+    classifyProps();
+  }
+  else {
+    //
+    // a changed draw layer changed the draw order; the props must be reindexed.
+    //
+    _propHotData->clear();
+    _propGrid.clear();
+    _movingProps.clear();
+    indexProps();
+  }
+
+  //
+  // the snapshots hold states which may no longer exist; they are recaptured on next reset.
+  //
+  _propSnapshots.clear();
+  _propHotDataSnapshot.clear();
+
+  _isBackgroundDirty = true;
+  _dirtyRects.invalidate();
 }
 
 void Level::unload()
 {
   _controlScheme.reset();
   _props.clear();
+  _propHotData->clear();
+  _propSnapshots.clear();
+  _propHotDataSnapshot.clear();
+  _propGrid.clear();
+  _movingProps.clear();
+  _propCandidates.clear();
+  _propHits.clear();
   _propInteractions.clear();
+  _drawList.clear();
+  _backgroundProps.clear();
+  _foregroundProps.clear();
+  _backgroundScreenid = -1;
+  _isBackgroundDirty = true;
+  _dirtyRects.invalidate();
+  _drawnCount = 0;
+  _culledCount = 0;
   _marioSpawnPosition.zero();
   _mario.reset();
   _isDebugDraw = false;
@@ -114,11 +382,33 @@ void Level::unload()
   _ending = ENDING_NONE;
 }
 
-void Level::onInit(std::shared_ptr<const ControlScheme> controlScheme)
+void Level::suspend()
+{
+  assert(_state != STATE_UNLOADED && _state != STATE_UNINITIALIZED);
+
+  _controlScheme.reset();
+  _mario.reset();
+  _propCandidates.clear();
+  _propHits.clear();
+  _propInteractions.clear();
+  _drawList.clear();
+  _backgroundScreenid = -1;
+  _isBackgroundDirty = true;
+  _dirtyRects.invalidate();
+  _drawnCount = 0;
+  _culledCount = 0;
+  _isDebugDraw = false;
+  _state = STATE_UNINITIALIZED;
+  _ending = ENDING_NONE;
+}
+
+void Level::onInit(std::shared_ptr<const ControlScheme> controlScheme, int backgroundScreenid)
 {
   assert(_state == STATE_UNINITIALIZED);
 
   _controlScheme = controlScheme;
+  _backgroundScreenid = backgroundScreenid;
+  _isBackgroundDirty = true;
 
   if(_mario == nullptr){
     _mario = std::unique_ptr<Mario>{new Mario{std::move(MarioFactory::makeMario(
@@ -127,6 +417,13 @@ void Level::onInit(std::shared_ptr<const ControlScheme> controlScheme)
     ))}};
   }
 
+  //
+  // props are built without playing their entry sounds (they may be built off the main
+  // thread, or long before they are played), so enter their initial states here.
+  //
+  resetProps();
+  captureProps();
+
   changeState(STATE_PLAYING); // TODO TEMP - implement cutscenes
 }
 
@@ -155,27 +452,133 @@ void Level::onUpdate(double now, float dt)
     _isDebugDraw = !_isDebugDraw;
 }
 
-void Level::onDraw(int screenid)
+void Level::onDraw(RenderBuffer& renderBuffer, int screenid)
 {
   assert(0 <= _state && _state < STATE_COUNT);
 
-  for(auto& prop : _props)
-    prop.onDraw(screenid);
+  Profiler::ScopedPhase phase {Profiler::PHASE_DRAW};
 
-  _mario->onDraw(screenid);
+  if(_backgroundScreenid >= 0 && _isBackgroundDirty)
+    drawBackground(renderBuffer);
 
-  if(_isDebugDraw)
-    debugDraw(screenid);
+  _drawList.clear();
+
+  if(_backgroundScreenid < 0)
+    for(int index : _backgroundProps)
+      _props[index].onDraw(_drawList);
+
+  for(int index : _foregroundProps)
+    _props[index].onDraw(_drawList);
+
+  _mario->onDraw(_drawList);
+
+  _drawnCount = _drawList.getCommandCount();
+  _culledCount = _drawList.getCulledCount();
+
+  if(_renderMode == RENDER_DIRTY_RECTS)
+    submitDirtyRects(renderBuffer, screenid);
+  else
+    _drawList.submit(renderBuffer, screenid);
+
+  if(_isDebugDraw){
+    debugDraw(renderBuffer, screenid);
+    _dirtyRects.invalidate();
+  }
+}
+
+void Level::setViewport(const pxr::iRect& viewport)
+{
+  _drawList.setCullRect(viewport);
+  _isBackgroundDirty = true;
+  _dirtyRects.invalidate();
+}
+
+void Level::setRenderMode(RenderMode mode)
+{
+  _renderMode = mode;
+  _dirtyRects.invalidate();
+}
+
+Level::RenderMode Level::getRenderMode() const
+{
+  return _renderMode;
+}
+
+void Level::setDebugFont(pxr::gfx::ResourceKey_t fontKey)
+{
+  _debugFontKey = fontKey;
+}
+
+void Level::invalidateScreen()
+{
+  _dirtyRects.invalidate();
+}
+
+void Level::submitDirtyRects(RenderBuffer& renderBuffer, int screenid)
+{
+  //
+  // note: relies on rectangle fills writing the color rather than blending it, so filling
+  // with a transparent color clears the rect.
+  //
+  static constexpr pxr::gfx::Color4u transparent {0, 0, 0, 0};
+
+  if(!_dirtyRects.update(_drawList.getCommands())){
+    renderBuffer.clearScreenTransparent(screenid);
+    _drawList.submit(renderBuffer, screenid);
+    return;
+  }
+
+  for(const auto& rect : _dirtyRects.getClearRects())
+    renderBuffer.drawFillRectangle(rect, transparent, screenid);
+
+  _drawList.submit(renderBuffer, screenid, _dirtyRects.getRedraws());
 }
 
 void Level::reset()
 {
   assert(0 <= _state && _state < STATE_COUNT);
 
+  restoreProps();
+
+  changeState(STATE_PLAYING); // TODO TEMP - implement cutscenes
+}
+
+void Level::resetProps()
+{
   for(auto& prop : _props)
     prop.reset();
 
-  changeState(STATE_PLAYING); // TODO TEMP - implement cutscenes
+  for(int index : _movingProps)
+    _propGrid.update(index, getHotInteractionBox(index));
+}
+
+void Level::captureProps()
+{
+  _propSnapshots.clear();
+  _propSnapshots.reserve(_props.size());
+  for(const auto& prop : _props)
+    _propSnapshots.push_back(prop.getSnapshot());
+
+  _propHotDataSnapshot = *_propHotData;
+}
+
+void Level::restoreProps()
+{
+  TraceScope scope {"Level::restoreProps"};
+
+  if(_propSnapshots.size() != _props.size()){
+    resetProps();
+    captureProps();
+    return;
+  }
+
+  for(size_t i = 0; i < _props.size(); ++i)
+    _props[i].restore(_propSnapshots[i]);
+
+  *_propHotData = _propHotDataSnapshot;
+
+  for(int index : _movingProps)
+    _propGrid.update(index, getHotInteractionBox(index));
 }
 
 bool Level::isOver()
@@ -265,7 +668,7 @@ void Level::updateEntranceCutscene(double now, float dt)
 
 void Level::updatePlaying(double now, float dt)
 {
-  static pxr::CollisionSubject subjectA, subjectB;
+  static MaskSubject subjectA, subjectB;
 
   if(_mario->isDying() && _isMusicPlaying)
     stopMusic();
@@ -275,47 +678,77 @@ void Level::updatePlaying(double now, float dt)
     return;
   }
 
+  Profiler::beginPhase(Profiler::PHASE_PROP_UPDATE);
+
   for(auto& prop : _props)
     prop.onUpdate(now, dt);
 
+  for(int index : _movingProps)
+    _propGrid.update(index, getHotInteractionBox(index));
+
+  Profiler::endPhase(Profiler::PHASE_PROP_UPDATE);
+  Profiler::beginPhase(Profiler::PHASE_INTERACTION);
+
+  const pxr::AABB& marioBox = _mario->getPropInteractionBox();
+  _propGrid.query(marioBox, _propCandidates);
+
+  const PropHotData& hot = *_propHotData;
+  AABBArrays boxes {hot._boxXMin.data(), hot._boxXMax.data(), hot._boxYMin.data(), hot._boxYMax.data()};
+  _propHits.resize(_propCandidates.size());
+  int hitCount = findAABBIntersections(marioBox, boxes, _propCandidates.data(), 
+                                       _propCandidates.size(), _propHits.data());
+
+  Profiler::endPhase(Profiler::PHASE_INTERACTION);
+  Profiler::beginPhase(Profiler::PHASE_PIXEL_TESTS);
+
   _propInteractions.clear();
-  for(auto& prop : _props){
-    if(pxr::isAABBIntersection(prop.getInteractionBox(), _mario->getPropInteractionBox())){
-      if(prop.isKiller()){
-        subjectA._position = _mario->getPosition();
-        subjectA._spritesheetKey = _mario->getSpritesheetKey();
-        subjectA._spriteid = _mario->getSpriteId();
-        subjectB._position = prop.getPosition();
-        subjectB._spritesheetKey = prop.getSpritesheetKey();
-        subjectB._spriteid = prop.getSpriteId();
-        const pxr::CollisionResult& result = pxr::isPixelIntersection(subjectA, subjectB);
-        if(!result._isCollision)
-          continue;
+  for(int i = 0; i < hitCount; ++i){
+    const int index = _propHits[i];
+    const Prop& prop = _props[index];
+    if(hot._effects[index] & PropHotData::EFFECT_KILLER){
+      subjectA._position = _mario->getPosition();
+      subjectA._mask = &(_mario->getSpriteMask());
+      subjectA._mirrorX = _mario->isMirroringX();
+      subjectA._mirrorY = _mario->isMirroringY();
+      subjectB._position = prop.getPosition();
+      subjectB._mask = &(prop.getSpriteMask());
+      subjectB._mirrorX = prop.isMirroringX();
+      subjectB._mirrorY = prop.isMirroringY();
+      if(!isOpaqueBoundsIntersection(subjectA, subjectB) ||
+         !isTileIntersection(subjectA, subjectB) ||
+         !isMaskIntersection(subjectA, subjectB))
+      {
+        continue;
       }
-      _propInteractions.push_back(&prop);
     }
+    _propInteractions.push_back(&prop);
   }
+
+  Profiler::endPhase(Profiler::PHASE_PIXEL_TESTS);
+  Profiler::beginPhase(Profiler::PHASE_MARIO);
+
   _mario->onPropInteractions(_propInteractions);
 
   _mario->onInput();
   _mario->onUpdate(now, dt);
 
+  Profiler::endPhase(Profiler::PHASE_MARIO);
 }
 
 void Level::updateExitCutscene(double now, float dt)
 {
 }
 
-void Level::debugDraw(int screenid)
+void Level::debugDraw(RenderBuffer& renderBuffer, int screenid)
 {
   pxr::iRect rect;
-  for(const auto& prop : _props){
-    const pxr::AABB& aabb = prop.getInteractionBox();
-    rect._x = aabb._xmin;
-    rect._y = aabb._ymin;
-    rect._w = aabb._xmax - aabb._xmin;
-    rect._h = aabb._ymax - aabb._ymin;
-    pxr::gfx::drawBorderRectangle(rect, pxr::gfx::colors::green, screenid);
+  const PropHotData& hot = *_propHotData;
+  for(int i = 0; i < hot.size(); ++i){
+    rect._x = hot._boxXMin[i];
+    rect._y = hot._boxYMin[i];
+    rect._w = hot._boxXMax[i] - hot._boxXMin[i];
+    rect._h = hot._boxYMax[i] - hot._boxYMin[i];
+    renderBuffer.drawBorderRectangle(rect, pxr::gfx::colors::green, screenid);
   }
 
   const pxr::AABB& aabb = _mario->getPropInteractionBox();
@@ -323,7 +756,41 @@ void Level::debugDraw(int screenid)
   rect._y = aabb._ymin;
   rect._w = aabb._xmax - aabb._xmin;
   rect._h = aabb._ymax - aabb._ymin;
-  pxr::gfx::drawBorderRectangle(rect, pxr::gfx::colors::yellow, screenid);
+  renderBuffer.drawBorderRectangle(rect, pxr::gfx::colors::yellow, screenid);
+
+  if(_debugFontKey < 0)
+    return;
+
+  std::string stats {};
+  stats += "drawn ";
+  stats += std::to_string(_drawnCount);
+  stats += " culled ";
+  stats += std::to_string(_culledCount);
+  renderBuffer.drawText(pxr::Vector2i{2, worldSize._y - 10}, stats, _debugFontKey, screenid);
+}
+
+void Level::drawBackground(RenderBuffer& renderBuffer)
+{
+  assert(_backgroundScreenid >= 0);
+
+  renderBuffer.clearScreenShade(1, _backgroundScreenid);
+
+  _drawList.clear();
+  for(int index : _backgroundProps)
+    _props[index].onDraw(_drawList);
+  _drawList.submit(renderBuffer, _backgroundScreenid);
+
+  _isBackgroundDirty = false;
+}
+
+pxr::AABB Level::getHotInteractionBox(int propIndex) const
+{
+  pxr::AABB aabb {};
+  aabb._xmin = _propHotData->_boxXMin[propIndex];
+  aabb._xmax = _propHotData->_boxXMax[propIndex];
+  aabb._ymin = _propHotData->_boxYMin[propIndex];
+  aabb._ymax = _propHotData->_boxYMax[propIndex];
+  return aabb;
 }
 
 void Level::startMusic()
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cassert>
+#include "pixiretro/pxr_log.h"
+#include "Trace.h"
+#include "LevelCache.h"
+
+//
+// log strings.
+//
+static constexpr const char* msg_preload_level = "preloading level";
+static constexpr const char* msg_evict_level = "evicting level from cache";
+
+LevelCache::LevelCache(int capacity) :
+  _capacity{capacity},
+  _levels{},
+  _thread{},
+  _mutex{},
+  _jobCondition{},
+  _builtCondition{},
+  _jobs{},
+  _building{},
+  _built{},
+  _isStopping{false}
+{
+  assert(_capacity > 0);
+}
+
+LevelCache::~LevelCache()
+{
+  stop();
+}
+
+void LevelCache::preload(const std::string& name)
+{
+  collectBuilt();
+
+  auto search = std::find_if(_levels.begin(), _levels.end(), [&name](const Entry& entry){
+    return entry._name == name;
+  });
+  if(search != _levels.end())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock {_mutex};
+    if(isPending(name))
+      return;
+    _jobs.push_back(name);
+  }
+
+  pxr::log::log(pxr::log::INFO, msg_preload_level, name);
+
+  if(!_thread.joinable()){
+    _isStopping = false;
+    _thread = std::thread{&LevelCache::run, this};
+  }
+
+  _jobCondition.notify_one();
+}
+
+std::unique_ptr<Level> LevelCache::take(const std::string& name)
+{
+  TraceScope scope {"LevelCache::take"};
+
+  {
+    std::unique_lock<std::mutex> lock {_mutex};
+    _builtCondition.wait(lock, [this, &name](){return !isPending(name);});
+  }
+
+  collectBuilt();
+
+  auto search = std::find_if(_levels.begin(), _levels.end(), [&name](const Entry& entry){
+    return entry._name == name;
+  });
+  if(search != _levels.end()){
+    std::unique_ptr<Level> level = std::move(search->_level);
+    _levels.erase(search);
+    return level;
+  }
+
+  auto level = std::unique_ptr<Level>{new Level()};
+  if(!level->load(name))
+    return nullptr;
+  return level;
+}
+
+void LevelCache::give(const std::string& name, std::unique_ptr<Level> level)
+{
+  assert(level != nullptr);
+  collectBuilt();
+  insert(Entry{name, std::move(level)});
+}
+
+void LevelCache::stop()
+{
+  if(!_thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock {_mutex};
+    _isStopping = true;
+    _jobs.clear();
+  }
+  _jobCondition.notify_one();
+  _thread.join();
+
+  collectBuilt();
+}
+
+void LevelCache::clear()
+{
+  stop();
+  _levels.clear();
+}
+
+void LevelCache::run()
+{
+  std::unique_lock<std::mutex> lock {_mutex};
+  while(true){
+    _jobCondition.wait(lock, [this](){return _isStopping || !_jobs.empty();});
+    if(_isStopping)
+      return;
+
+    Built built {std::move(_jobs.front()), nullptr, {}};
+    _jobs.pop_front();
+    _building = built._name;
+    lock.unlock();
+
+    Level::Layout layout {};
+    if(Level::parse(built._name, &layout, &built._messages)){
+      built._level = std::unique_ptr<Level>{new Level()};
+      built._level->build(layout);
+    }
+
+    lock.lock();
+    _built.push_back(std::move(built));
+    _building.clear();
+    _builtCondition.notify_all();
+  }
+}
+
+void LevelCache::collectBuilt()
+{
+  std::vector<Built> built {};
+  {
+    std::lock_guard<std::mutex> lock {_mutex};
+    built.swap(_built);
+  }
+  for(auto& level : built){
+    Level::logMessages(level._messages);
+    if(level._level != nullptr)
+      insert(Entry{std::move(level._name), std::move(level._level)});
+  }
+}
+
+void LevelCache::insert(Entry entry)
+{
+  //
+  // a level may be built while another instance of it is being played; keep the newest.
+  //
+  _levels.remove_if([&entry](const Entry& cached){return cached._name == entry._name;});
+
+  _levels.push_front(std::move(entry));
+
+  while(static_cast<int>(_levels.size()) > _capacity){
+    pxr::log::log(pxr::log::INFO, msg_evict_level, _levels.back()._name);
+    _levels.pop_back();
+  }
+}
+
+bool LevelCache::isPending(const std::string& name) const
+{
+  if(_building == name)
+    return true;
+  return std::find(_jobs.begin(), _jobs.end(), name) != _jobs.end();
+}
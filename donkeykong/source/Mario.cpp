@@ -1,6 +1,7 @@
 #include <cassert>
 #include "Mario.h"
 #include "AnimationFactory.h"
+#include "InputReplay.h"
 #include "Prop.h"
 
 #include <iostream>
@@ -31,6 +32,7 @@ Mario::Mario(pxr::Vector2f                        spawnPosition,
 
 Mario::Definition::Definition(
   std::array<std::string, Mario::STATE_COUNT>                              animationNames,
+  std::array<int, Mario::STATE_COUNT>                                      animationHandles,
   std::array<std::pair<pxr::sfx::ResourceKey_t, bool>, Mario::STATE_COUNT> sounds,
   pxr::Vector2i                                                            size,
   pxr::fRect                                                               propInteractionBox,
@@ -46,6 +48,7 @@ Mario::Definition::Definition(
   float                                                                    dyingDuration)
   :
   _animationNames{std::move(animationNames)},
+  _animationHandles{animationHandles},
   _sounds{sounds},
   _size{size},
   _propInteractionBox{propInteractionBox},
@@ -59,7 +62,10 @@ Mario::Definition::Definition(
   _spawnHealth{spawnHealth},
   _spawnDuration{spawnDuration},
   _dyingDuration{dyingDuration}
-{}
+{
+  for(int state = 0; state < STATE_COUNT; ++state)
+    assert(_animationHandles[state] >= 0);
+}
 
 void Mario::onInput()
 {
@@ -67,36 +73,36 @@ void Mario::onInput()
     return;
 
   if(_state == STATE_IDLE){
-    if(pxr::input::isKeyDown(_controlScheme->_runLeftKey)){
+    if(InputReplay::isKeyDown(_controlScheme->_runLeftKey)){
       _direction._x = -1.f;
       changeState(STATE_RUNNING);
     }
 
-    else if(pxr::input::isKeyDown(_controlScheme->_runRightKey)){
+    else if(InputReplay::isKeyDown(_controlScheme->_runRightKey)){
       _direction._x = 1.f;
       changeState(STATE_RUNNING);
     }
 
-    else if(pxr::input::isKeyDown(_controlScheme->_jumpKey))
+    else if(InputReplay::isKeyDown(_controlScheme->_jumpKey))
       changeState(STATE_JUMPING);
   }
 
   else if(_state == STATE_RUNNING){
-    if(_direction._x < 0 && !pxr::input::isKeyDown(_controlScheme->_runLeftKey))
+    if(_direction._x < 0 && !InputReplay::isKeyDown(_controlScheme->_runLeftKey))
       changeState(STATE_IDLE);
 
-    if(_direction._x > 0 && !pxr::input::isKeyDown(_controlScheme->_runRightKey))
+    if(_direction._x > 0 && !InputReplay::isKeyDown(_controlScheme->_runRightKey))
       changeState(STATE_IDLE);
 
-    if(pxr::input::isKeyPressed(_controlScheme->_jumpKey))
+    if(InputReplay::isKeyPressed(_controlScheme->_jumpKey))
       changeState(STATE_JUMPING);
   }
 
   if(_isNearLadder && (_state == STATE_IDLE || _state == STATE_RUNNING || _state == STATE_CLIMBING_IDLE)){
-    if(pxr::input::isKeyDown(_controlScheme->_climbUpKey))
+    if(InputReplay::isKeyDown(_controlScheme->_climbUpKey))
       changeState(STATE_CLIMBING_UP);
 
-    else if(pxr::input::isKeyDown(_controlScheme->_climbDownKey)){
+    else if(InputReplay::isKeyDown(_controlScheme->_climbDownKey)){
       if(_state == STATE_CLIMBING_IDLE)
         changeState(STATE_CLIMBING_DOWN);
 
@@ -112,10 +118,10 @@ void Mario::onInput()
     }
   }
 
-  else if(_state == STATE_CLIMBING_UP && !pxr::input::isKeyDown(_controlScheme->_climbUpKey))
+  else if(_state == STATE_CLIMBING_UP && !InputReplay::isKeyDown(_controlScheme->_climbUpKey))
     changeState(STATE_CLIMBING_IDLE);
 
-  else if(_state == STATE_CLIMBING_DOWN && !pxr::input::isKeyDown(_controlScheme->_climbDownKey))
+  else if(_state == STATE_CLIMBING_DOWN && !InputReplay::isKeyDown(_controlScheme->_climbDownKey))
     changeState(STATE_CLIMBING_IDLE);
 
 
@@ -196,12 +202,12 @@ void Mario::onUpdate(double now, float dt)
   }
 }
 
-void Mario::onDraw(int screenid)
+void Mario::onDraw(DrawList& drawList)
 {
   if(_state == STATE_DEAD)
     return;
 
-  _animation.onDraw(_position, screenid);
+  _animation.onDraw(_position, drawLayer, drawList);
 }
 
 void Mario::onPropInteractions(const std::vector<const Prop*>& props)
@@ -297,6 +303,21 @@ pxr::gfx::SpriteId_t Mario::getSpriteId() const
   return _animation.getSpriteId();
 }
 
+const SpriteMask& Mario::getSpriteMask() const
+{
+  return _animation.getSpriteMask();
+}
+
+bool Mario::isMirroringX() const
+{
+  return _animation.isMirroringX();
+}
+
+bool Mario::isMirroringY() const
+{
+  return _animation.isMirroringY();
+}
+
 void Mario::changeState(State state)
 {
   assert(0 <= state && state < STATE_COUNT);
@@ -384,7 +405,7 @@ void Mario::changeState(State state)
       break;
   }
 
-  _animation = AnimationFactory::makeAnimation(_def->_animationNames[_state]);
+  _animation = AnimationFactory::makeAnimation(_def->_animationHandles[_state]);
   _animation.setMirrorX(_direction._x > 0.f);
 
   auto& sound = _def->_sounds[_state];
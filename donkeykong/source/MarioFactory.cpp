@@ -7,6 +7,8 @@
 #include "pixiretro/pxr_log.h"
 #include "pixiretro/pxr_rect.h"
 #include "MarioFactory.h"
+#include "AnimationFactory.h"
+#include "ResourceCache.h"
 
 using namespace tinyxml2;
 
@@ -34,19 +36,53 @@ void MarioFactory::shutdown()
   if(instance == nullptr)
     return;
 
-  for(auto& pair : instance->_marioDefinition->_sounds)
-    if(pair.first != -1)
-      pxr::sfx::unloadSound(pair.first);
+  for(auto& soundName : instance->_soundNames)
+    ResourceCache::releaseSound(soundName);
 
   instance.reset();
 }
 
+bool MarioFactory::reload()
+{
+  assert(instance != nullptr);
+
+  auto def = std::move(instance->_marioDefinition);
+  auto soundNames = std::move(instance->_soundNames);
+  instance->_marioDefinition = nullptr;
+  instance->_soundNames.clear();
+
+  if(!instance->loadMarioDefinition()){
+    for(auto& soundName : instance->_soundNames)
+      ResourceCache::releaseSound(soundName);
+    instance->_soundNames = std::move(soundNames);
+    instance->_marioDefinition = std::move(def);
+    return false;
+  }
+
+  //
+  // patch in place so existing marios see the change; old sounds are released after the
+  // new are acquired so sounds still in use are not reloaded.
+  //
+  *def = std::move(*(instance->_marioDefinition));
+  instance->_marioDefinition = std::move(def);
+  for(auto& soundName : soundNames)
+    ResourceCache::releaseSound(soundName);
+
+  return true;
+}
+
 Mario MarioFactory::makeMario(pxr::Vector2f spawnPosition, std::shared_ptr<const ControlScheme> controlScheme)
 {
   assert(instance != nullptr);
   return Mario(spawnPosition, controlScheme, instance->_marioDefinition); 
 }
 
+pxr::sfx::ResourceKey_t MarioFactory::acquireSound(const char* soundName)
+{
+  _soundNames.push_back(soundName);
+  return ResourceCache::acquireSound(soundName);
+}
+
 bool MarioFactory::loadMarioDefinition()
 {
   assert(_marioDefinition == nullptr); 
@@ -122,6 +158,12 @@ bool MarioFactory::loadMarioDefinition()
   if(!pxr::io::extractStringAttribute(xmlanimations, "die", &cstr)) return onerror();
   animationNames[Mario::STATE_DYING] = std::string{cstr};
 
+  std::array<int, Mario::STATE_COUNT> animationHandles;
+  for(int state = 0; state < Mario::STATE_COUNT; ++state){
+    animationHandles[state] = AnimationFactory::findAnimation(animationNames[state]);
+    if(animationHandles[state] < 0) return onerror();
+  }
+
   int loop {false};
   std::array<std::pair<pxr::sfx::ResourceKey_t, bool>, Mario::STATE_COUNT> sounds;
 
@@ -133,7 +175,7 @@ bool MarioFactory::loadMarioDefinition()
   if(std::strcmp(cstr, "NA") == 0 || std::strlen(cstr) == 0)
     sounds[Mario::STATE_IDLE].first = -1;
   else
-    sounds[Mario::STATE_IDLE].first = pxr::sfx::loadSound(cstr);
+    sounds[Mario::STATE_IDLE].first = acquireSound(cstr);
   sounds[Mario::STATE_IDLE].second = static_cast<bool>(loop);
 
   if(!pxr::io::extractStringAttribute(xmlsounds, "run", &cstr)) return onerror();
@@ -141,7 +183,7 @@ bool MarioFactory::loadMarioDefinition()
   if(std::strcmp(cstr, "NA") == 0 || std::strlen(cstr) == 0)
     sounds[Mario::STATE_RUNNING].first = -1;
   else
-    sounds[Mario::STATE_RUNNING].first = pxr::sfx::loadSound(cstr);
+    sounds[Mario::STATE_RUNNING].first = acquireSound(cstr);
   sounds[Mario::STATE_RUNNING].second = static_cast<bool>(loop);
 
   if(!pxr::io::extractStringAttribute(xmlsounds, "climbIdle", &cstr)) return onerror();
@@ -149,7 +191,7 @@ bool MarioFactory::loadMarioDefinition()
   if(std::strcmp(cstr, "NA") == 0 || std::strlen(cstr) == 0)
     sounds[Mario::STATE_CLIMBING_IDLE].first = -1;
   else
-    sounds[Mario::STATE_CLIMBING_IDLE].first = pxr::sfx::loadSound(cstr);
+    sounds[Mario::STATE_CLIMBING_IDLE].first = acquireSound(cstr);
   sounds[Mario::STATE_CLIMBING_IDLE].second = static_cast<bool>(loop);
 
   if(!pxr::io::extractStringAttribute(xmlsounds, "climbUp", &cstr)) return onerror();
@@ -157,7 +199,7 @@ bool MarioFactory::loadMarioDefinition()
   if(std::strcmp(cstr, "NA") == 0 || std::strlen(cstr) == 0)
     sounds[Mario::STATE_CLIMBING_UP].first = -1;
   else
-    sounds[Mario::STATE_CLIMBING_UP].first = pxr::sfx::loadSound(cstr);
+    sounds[Mario::STATE_CLIMBING_UP].first = acquireSound(cstr);
   sounds[Mario::STATE_CLIMBING_UP].second = static_cast<bool>(loop);
 
   if(!pxr::io::extractStringAttribute(xmlsounds, "climbDown", &cstr)) return onerror();
@@ -165,7 +207,7 @@ bool MarioFactory::loadMarioDefinition()
   if(std::strcmp(cstr, "NA") == 0 || std::strlen(cstr) == 0)
     sounds[Mario::STATE_CLIMBING_DOWN].first = -1;
   else
-    sounds[Mario::STATE_CLIMBING_DOWN].first = pxr::sfx::loadSound(cstr);
+    sounds[Mario::STATE_CLIMBING_DOWN].first = acquireSound(cstr);
   sounds[Mario::STATE_CLIMBING_DOWN].second = static_cast<bool>(loop);
 
   if(!pxr::io::extractStringAttribute(xmlsounds, "climbOff", &cstr)) return onerror();
@@ -173,7 +215,7 @@ bool MarioFactory::loadMarioDefinition()
   if(std::strcmp(cstr, "NA") == 0 || std::strlen(cstr) == 0)
     sounds[Mario::STATE_CLIMBING_OFF].first = -1;
   else
-    sounds[Mario::STATE_CLIMBING_OFF].first = pxr::sfx::loadSound(cstr);
+    sounds[Mario::STATE_CLIMBING_OFF].first = acquireSound(cstr);
   sounds[Mario::STATE_CLIMBING_OFF].second = static_cast<bool>(loop);
 
   if(!pxr::io::extractStringAttribute(xmlsounds, "climbOn", &cstr)) return onerror();
@@ -181,7 +223,7 @@ bool MarioFactory::loadMarioDefinition()
   if(std::strcmp(cstr, "NA") == 0 || std::strlen(cstr) == 0)
     sounds[Mario::STATE_CLIMBING_ON].first = -1;
   else
-    sounds[Mario::STATE_CLIMBING_ON].first = pxr::sfx::loadSound(cstr);
+    sounds[Mario::STATE_CLIMBING_ON].first = acquireSound(cstr);
   sounds[Mario::STATE_CLIMBING_ON].second = static_cast<bool>(loop);
 
   if(!pxr::io::extractStringAttribute(xmlsounds, "jump", &cstr)) return onerror();
@@ -189,7 +231,7 @@ bool MarioFactory::loadMarioDefinition()
   if(std::strcmp(cstr, "NA") == 0 || std::strlen(cstr) == 0)
     sounds[Mario::STATE_JUMPING].first = -1;
   else
-    sounds[Mario::STATE_JUMPING].first = pxr::sfx::loadSound(cstr);
+    sounds[Mario::STATE_JUMPING].first = acquireSound(cstr);
   sounds[Mario::STATE_JUMPING].second = static_cast<bool>(loop);
 
   if(!pxr::io::extractStringAttribute(xmlsounds, "fall", &cstr)) return onerror();
@@ -197,7 +239,7 @@ bool MarioFactory::loadMarioDefinition()
   if(std::strcmp(cstr, "NA") == 0 || std::strlen(cstr) == 0)
     sounds[Mario::STATE_FALLING].first = -1;
   else
-    sounds[Mario::STATE_FALLING].first = pxr::sfx::loadSound(cstr);
+    sounds[Mario::STATE_FALLING].first = acquireSound(cstr);
   sounds[Mario::STATE_FALLING].second = static_cast<bool>(loop);
 
   if(!pxr::io::extractStringAttribute(xmlsounds, "die", &cstr)) return onerror();
@@ -205,7 +247,7 @@ bool MarioFactory::loadMarioDefinition()
   if(std::strcmp(cstr, "NA") == 0 || std::strlen(cstr) == 0)
     sounds[Mario::STATE_DYING].first = -1;
   else
-    sounds[Mario::STATE_DYING].first = pxr::sfx::loadSound(cstr);
+    sounds[Mario::STATE_DYING].first = acquireSound(cstr);
   sounds[Mario::STATE_DYING].second = static_cast<bool>(loop);
 
   if(!pxr::io::extractChildElement(xmlmario, &xmlpropbox, "propBox"))
@@ -220,6 +262,7 @@ bool MarioFactory::loadMarioDefinition()
 
   _marioDefinition = std::shared_ptr<Mario::Definition>{new Mario::Definition(
     std::move(animationNames),
+    animationHandles,
     std::move(sounds),
     pxr::Vector2i{marioW, marioH},
     propBox,
@@ -1,8 +1,17 @@
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include "pixiretro/pxr_gfx.h"
 #include "pixiretro/pxr_xml.h"
 #include "pixiretro/pxr_log.h"
+#include "AnimationFactory.h"
+#include "AssetPack.h"
+#include "AssetWatcher.h"
+#include "MarioFactory.h"
+#include "PropFactory.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "Defines.h"
 #include "PlayState.h"
 
 using namespace tinyxml2;
@@ -11,16 +20,31 @@ static constexpr const char* msg_load_start {"loading dkconfig file"};
 static constexpr const char* msg_load_abort {"aborting dkconfig load due to error"};
 static constexpr const char* msg_load_success {"successfully loaded dkconfig file"};
 static constexpr const char* msg_invalid_key {"invalid key string"};
-
-PlayState::PlayState(pxr::App* owner) :
+static constexpr const char* msg_invalid_replay_mode {"invalid replay mode; expected record or playback"};
+static constexpr const char* msg_invalid_render_mode {"invalid render mode; expected full or dirtyRects"};
+static constexpr const char* msg_change_level_fail {"failed to load level; staying on the current level"};
+static constexpr const char* msg_asset_changed {"asset changed, reloading"};
+static constexpr const char* msg_reload_fail {"failed to reload asset; keeping the loaded version"};
+static constexpr const char* msg_pack_closed {"packed asset changed, closing asset pack and loading from xml"};
+
+PlayState::PlayState(pxr::App* owner, InputReplay::Mode replayMode, std::string replayName) :
   pxr::AppState(owner),
   _levelNames{},
   _currentLevel{0},
-  _level{},
+  _level{nullptr},
+  _levelCache{},
   _controlScheme{nullptr},
+  _backgroundScreenid{-1},
+  _renderMode{Level::RENDER_FULL},
+  _debugFontKey{-1},
+  _renderBuffer{},
   _marioLives{0},
   _score{0},
-  _isCheating{true}
+  _isCheating{true},
+  _isProfilerOverlay{false},
+  _isHotReloading{false},
+  _replayMode{replayMode},
+  _replayName{std::move(replayName)}
 {
   assert(owner != nullptr);
 }
@@ -33,26 +57,65 @@ bool PlayState::onInit()
   if(!loadDKConfig())
     return false;
 
-  if(!_level.load(_levelNames[_currentLevel]))
+  std::vector<pxr::input::KeyCode> replayKeys {
+    _controlScheme->_runLeftKey,
+    _controlScheme->_runRightKey,
+    _controlScheme->_jumpKey,
+    _controlScheme->_climbUpKey,
+    _controlScheme->_climbDownKey,
+    nextLevelCheatKey,
+    prevLevelCheatKey
+  };
+
+  if(!InputReplay::initialize(_replayMode, _replayName, replayKeys))
     return false;
 
-  _level.onInit(_controlScheme);
+  _backgroundScreenid = pxr::gfx::createScreen(worldSize);
+  _debugFontKey = pxr::gfx::loadFont(debugFontName);
+
+  if(_isHotReloading)
+    AssetWatcher::initialize();
+
+  _level = _levelCache.take(_levelNames[_currentLevel]);
+  if(_level == nullptr)
+    return false;
+
+  _level->setRenderMode(_renderMode);
+  _level->setDebugFont(_debugFontKey);
+  _level->onInit(_controlScheme, _backgroundScreenid);
+
+  preloadNextLevel();
 
   return true;
 }
 
 void PlayState::onUpdate(double now, float dt)
 {
+  TraceScope scope {"PlayState::onUpdate"};
+
+  dt = InputReplay::onTick(dt);
+
+  if(InputReplay::isPlaybackOver())
+    quit(EXIT_SUCCESS);
+
+  Profiler::ScopedPhase phase {Profiler::PHASE_UPDATE};
+
   if(_isCheating)
     onCheatInput();
 
-  _level.onUpdate(now, dt);
+  if(pxr::input::isKeyPressed(profilerOverlayToggleKey))
+    _isProfilerOverlay = !_isProfilerOverlay;
+
+  if(_isHotReloading)
+    onAssetChanges();
+
+  _level->onUpdate(now, dt);
 
   //
   // note: this MUST be done last since it potentially replaces the level with a different one.
   //
-  if(_level.isOver()){
-    Level::Ending ending = _level.getEnding();
+  if(_level->isOver()){
+    Level::Ending ending = _level->getEnding();
     if(ending == Level::ENDING_LOSS)
       handleLevelLoss();
     else if(ending == Level::ENDING_WIN)
@@ -62,68 +125,205 @@ void PlayState::onUpdate(double now, float dt)
 
 void PlayState::onDraw(double now, float dt, int screenid)
 {
-  pxr::gfx::clearScreenShade(1, screenid);
-  _level.onDraw(screenid);
+  TraceScope scope {"PlayState::onDraw"};
+
+  _renderBuffer.clear();
+
+  if(_level->getRenderMode() == Level::RENDER_FULL)
+    _renderBuffer.clearScreenTransparent(screenid);
+
+  _level->onDraw(_renderBuffer, screenid);
+
+  if(_isProfilerOverlay){
+    Profiler::drawOverlay(_renderBuffer, screenid);
+    _level->invalidateScreen();
+  }
+
+  _renderBuffer.execute();
+
+  Profiler::endFrame();
 }
 
 void PlayState::onReset()
 {
 }
 
+void PlayState::onShutdown()
+{
+  _levelCache.stop();
+  AssetWatcher::shutdown();
+  if(_debugFontKey >= 0){
+    pxr::gfx::unloadFont(_debugFontKey);
+    _debugFontKey = -1;
+  }
+}
+
 void PlayState::onCheatInput()
 {
-  if(pxr::input::isKeyPressed(nextLevelCheatKey))
+  if(InputReplay::isKeyPressed(nextLevelCheatKey))
     nextLevel(true);
 
-  else if(pxr::input::isKeyPressed(prevLevelCheatKey))
+  else if(InputReplay::isKeyPressed(prevLevelCheatKey))
     prevLevel(true);
 }
 
 bool PlayState::nextLevel(bool loop)
 {
-  ++_currentLevel;
-  if(_currentLevel >= _levelNames.size()){
+  int levelIndex = _currentLevel + 1;
+  if(levelIndex >= _levelNames.size()){
     if(loop)
-      _currentLevel = 0;
+      levelIndex = 0;
     else
       return false;
   }
 
-  _level.unload();
-
-  if(!_level.load(_levelNames[_currentLevel]))
-    std::exit(EXIT_FAILURE);
-
-  _level.onInit(_controlScheme);
+  if(!changeLevel(levelIndex) && _level->isOver())
+    _level->reset();
 
   return true;
 }
 
 bool PlayState::prevLevel(bool loop)
 {
-  --_currentLevel;
-  if(_currentLevel < 0){
+  int levelIndex = _currentLevel - 1;
+  if(levelIndex < 0){
     if(loop)
-      _currentLevel = _levelNames.size() - 1;
+      levelIndex = _levelNames.size() - 1;
     else
       return false;
   }
 
-  _level.unload();
+  if(!changeLevel(levelIndex) && _level->isOver())
+    _level->reset();
+
+  return true;
+}
+
+bool PlayState::changeLevel(int levelIndex)
+{
+  TraceScope scope {"PlayState::changeLevel"};
+
+  std::unique_ptr<Level> level = _levelCache.take(_levelNames[levelIndex]);
+  if(level == nullptr){
+    pxr::log::log(pxr::log::ERROR, msg_change_level_fail, _levelNames[levelIndex]);
+    return false;
+  }
+
+  _level->suspend();
+  _levelCache.give(_levelNames[_currentLevel], std::move(_level));
 
-  if(!_level.load(_levelNames[_currentLevel]))
-    std::exit(EXIT_FAILURE);
+  _level = std::move(level);
+  _currentLevel = levelIndex;
 
-  _level.onInit(_controlScheme);
+  _level->setRenderMode(_renderMode);
+  _level->setDebugFont(_debugFontKey);
+  _level->onInit(_controlScheme, _backgroundScreenid);
+
+  preloadNextLevel();
 
   return true;
 }
 
+void PlayState::preloadNextLevel()
+{
+  int levelIndex = _currentLevel + 1;
+  if(levelIndex < static_cast<int>(_levelNames.size()))
+    _levelCache.preload(_levelNames[levelIndex]);
+}
+
+void PlayState::onAssetChanges()
+{
+  auto isXmlFile = [](const std::string& path, const char* dir, const char* name){
+    std::string xmlpath {};
+    xmlpath += dir;
+    xmlpath += name;
+    xmlpath += pxr::io::XML_FILE_EXTENSION;
+    return path == xmlpath;
+  };
+
+  const std::string levelPath {Level::RESOURCE_PATH_LEVEL};
+  const std::string xmlExtension {pxr::io::XML_FILE_EXTENSION};
+
+  for(const auto& path : AssetWatcher::poll()){
+    TraceScope scope {"PlayState::onAssetChanges"};
+
+    //
+    // the level cache builds levels from the factories' definitions on its loader thread, so
+    // is cleared before they change.
+    //
+    if(isXmlFile(path, AnimationFactory::ANIMATION_DEFINITIONS_FILE_PATH, AnimationFactory::ANIMATION_DEFINITIONS_FILE_NAME)){
+      pxr::log::log(pxr::log::INFO, msg_asset_changed, path);
+      _levelCache.clear();
+      if(!AnimationFactory::reload())
+        pxr::log::log(pxr::log::ERROR, msg_reload_fail, path);
+      preloadNextLevel();
+    }
+    else if(isXmlFile(path, PropFactory::PROP_DEFINITIONS_FILE_PATH, PropFactory::PROP_DEFINITIONS_FILE_NAME)){
+      pxr::log::log(pxr::log::INFO, msg_asset_changed, path);
+      _levelCache.clear();
+      closeAssetPack();
+      if(PropFactory::reload())
+        _level->onPropDefinitionsChanged();
+      else
+        pxr::log::log(pxr::log::ERROR, msg_reload_fail, path);
+      preloadNextLevel();
+    }
+    else if(isXmlFile(path, MarioFactory::MARIO_DEFINITION_FILE_PATH, MarioFactory::MARIO_DEFINITION_FILE_NAME)){
+      pxr::log::log(pxr::log::INFO, msg_asset_changed, path);
+      if(!MarioFactory::reload())
+        pxr::log::log(pxr::log::ERROR, msg_reload_fail, path);
+    }
+    else if(path.size() > levelPath.size() + xmlExtension.size() &&
+            path.compare(0, levelPath.size(), levelPath) == 0 &&
+            path.compare(path.size() - xmlExtension.size(), xmlExtension.size(), xmlExtension) == 0)
+    {
+      pxr::log::log(pxr::log::INFO, msg_asset_changed, path);
+      reloadLevel(path.substr(levelPath.size(), path.size() - levelPath.size() - xmlExtension.size()));
+    }
+  }
+}
+
+void PlayState::reloadLevel(const std::string& levelName)
+{
+  _levelCache.clear();
+  closeAssetPack();
+
+  //
+  // only the level being played is rebuilt now, others are loaded when next played.
+  //
+  if(levelName == _levelNames[_currentLevel]){
+    Level::Layout layout {};
+    if(!Level::parseXml(levelName, &layout)){
+      pxr::log::log(pxr::log::ERROR, msg_reload_fail, levelName);
+    }
+    else {
+      auto level = std::unique_ptr<Level>{new Level()};
+      level->build(layout);
+      _level->unload();
+      _level = std::move(level);
+      _level->setRenderMode(_renderMode);
+      _level->setDebugFont(_debugFontKey);
+      _level->onInit(_controlScheme, _backgroundScreenid);
+    }
+  }
+
+  preloadNextLevel();
+}
+
+void PlayState::closeAssetPack()
+{
+  if(!AssetPack::isOpen())
+    return;
+
+  pxr::log::log(pxr::log::INFO, msg_pack_closed);
+  AssetPack::shutdown();
+}
+
 void PlayState::handleLevelWin()
 {
   if(!nextLevel(false)){
     // TODO switch back to menu state or a game complete state or something
-    std::exit(EXIT_FAILURE);
+    quit(EXIT_FAILURE);
   }
 }
 
@@ -133,9 +333,15 @@ void PlayState::handleLevelLoss()
 
   if(_marioLives <= 0){
     // TODO switch back to menu state or game over state or something.
-    std::exit(EXIT_FAILURE);
+    quit(EXIT_FAILURE);
   }
-  _level.reset();
+  _level->reset();
+}
+
+void PlayState::quit(int status)
+{
+  _owner->onShutdown();
+  std::exit(status);
 }
 
 bool PlayState::loadDKConfig()
@@ -197,6 +403,54 @@ bool PlayState::loadDKConfig()
   if(!pxr::io::extractIntAttribute(xmlmario, "lives", &_marioLives)) return onerror();
   _marioLives = std::clamp(_marioLives, 0, std::numeric_limits<int>::max());
 
+  //
+  // the replay element is optional; without it input is live. A replay passed to the
+  // constructor takes precedence.
+  //
+  XMLElement* xmlreplay = xmldkconfig->FirstChildElement("replay");
+  if(xmlreplay != nullptr && _replayMode == InputReplay::MODE_LIVE){
+    const char* modeString {nullptr};
+    const char* replayName {nullptr};
+    if(!pxr::io::extractStringAttribute(xmlreplay, "mode", &modeString)) return onerror();
+    if(!pxr::io::extractStringAttribute(xmlreplay, "name", &replayName)) return onerror();
+    if(std::strcmp(modeString, "record") == 0)
+      _replayMode = InputReplay::MODE_RECORD;
+    else if(std::strcmp(modeString, "playback") == 0)
+      _replayMode = InputReplay::MODE_PLAYBACK;
+    else {
+      pxr::log::log(pxr::log::ERROR, msg_invalid_replay_mode, modeString);
+      return onerror();
+    }
+    _replayName = replayName;
+  }
+
+  //
+  // the rendering element is optional; without it the whole screen is redrawn every frame.
+  //
+  XMLElement* xmlrendering = xmldkconfig->FirstChildElement("rendering");
+  if(xmlrendering != nullptr){
+    const char* modeString {nullptr};
+    if(!pxr::io::extractStringAttribute(xmlrendering, "mode", &modeString)) return onerror();
+    if(std::strcmp(modeString, "full") == 0)
+      _renderMode = Level::RENDER_FULL;
+    else if(std::strcmp(modeString, "dirtyRects") == 0)
+      _renderMode = Level::RENDER_DIRTY_RECTS;
+    else {
+      pxr::log::log(pxr::log::ERROR, msg_invalid_render_mode, modeString);
+      return onerror();
+    }
+  }
+
+  //
+  // the hotReload element is optional; without it assets are only loaded at startup.
+  //
+  XMLElement* xmlhotreload = xmldkconfig->FirstChildElement("hotReload");
+  if(xmlhotreload != nullptr){
+    int isEnabled {0};
+    if(!pxr::io::extractIntAttribute(xmlhotreload, "enabled", &isEnabled)) return onerror();
+    _isHotReloading = static_cast<bool>(isEnabled);
+  }
+
   if(!pxr::io::extractChildElement(xmldkconfig, &xmllevels, "levels"))
     return onerror();
 
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include "pixiretro/pxr_gfx.h"
+#include "pixiretro/pxr_log.h"
+#include "Defines.h"
+#include "Profiler.h"
+
+//
+// log strings.
+//
+static constexpr const char* msg_report_start = "frame profile (per frame, over all frames)";
+static constexpr const char* msg_report_phase = "frame profile phase";
+
+std::array<Profiler::Clock_t::time_point, Profiler::PHASE_COUNT> Profiler::phaseStarts {};
+std::array<Profiler::PhaseStats, Profiler::PHASE_COUNT> Profiler::phaseStats {};
+
+Profiler::Frame Profiler::currentFrame {};
+std::array<Profiler::Slot, Profiler::frameCapacity> Profiler::slots {};
+std::atomic<uint64_t> Profiler::frameCount {0};
+
+std::array<Profiler::Histogram, Profiler::PHASE_COUNT> Profiler::histograms {};
+
+void Profiler::beginPhase(Phase phase)
+{
+  assert(0 <= phase && phase < PHASE_COUNT);
+  phaseStarts[phase] = Clock_t::now();
+}
+
+void Profiler::endPhase(Phase phase)
+{
+  assert(0 <= phase && phase < PHASE_COUNT);
+  auto elapsed = Clock_t::now() - phaseStarts[phase];
+  int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  phaseStats[phase]._totalNanoseconds += nanoseconds;
+  ++phaseStats[phase]._sampleCount;
+  currentFrame._phaseNanoseconds[phase] += nanoseconds;
+}
+
+void Profiler::endFrame()
+{
+  uint64_t frameNo = frameCount.load(std::memory_order_relaxed);
+  Slot& slot = slots[frameNo % frameCapacity];
+  uint64_t sequence = slot._sequence.load(std::memory_order_relaxed);
+  slot._sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for(int phase = 0; phase < PHASE_COUNT; ++phase)
+    slot._phaseNanoseconds[phase].store(currentFrame._phaseNanoseconds[phase], std::memory_order_relaxed);
+  slot._sequence.store(sequence + 2, std::memory_order_release);
+  frameCount.store(frameNo + 1, std::memory_order_release);
+
+  for(int phase = 0; phase < PHASE_COUNT; ++phase){
+    int64_t nanoseconds = currentFrame._phaseNanoseconds[phase];
+    Histogram& histogram = histograms[phase];
+    int bucket = std::min<int64_t>(nanoseconds / histogramBucketNanoseconds, histogramBucketCount - 1);
+    ++histogram._buckets[bucket];
+    histogram._minNanoseconds = histogram._frameCount == 0 ? nanoseconds :
+                                std::min(histogram._minNanoseconds, nanoseconds);
+    histogram._totalNanoseconds += nanoseconds;
+    ++histogram._frameCount;
+  }
+
+  currentFrame._phaseNanoseconds.fill(0);
+}
+
+const Profiler::PhaseStats& Profiler::getPhaseStats(Phase phase)
+{
+  assert(0 <= phase && phase < PHASE_COUNT);
+  return phaseStats[phase];
+}
+
+const char* Profiler::getPhaseName(Phase phase)
+{
+  switch(phase){
+    case PHASE_UPDATE: return "update";
+    case PHASE_PROP_UPDATE: return "prop update";
+    case PHASE_INTERACTION: return "interaction";
+    case PHASE_PIXEL_TESTS: return "pixel tests";
+    case PHASE_MARIO: return "mario";
+    case PHASE_DRAW: return "draw";
+    default: assert(0); return "";
+  }
+}
+
+uint64_t Profiler::getFrameCount()
+{
+  return frameCount.load(std::memory_order_acquire);
+}
+
+bool Profiler::getFrame(uint64_t frameNo, Frame* frame)
+{
+  assert(frame != nullptr);
+
+  //
+  // the slot holds frameNo once it has been written frameNo / frameCapacity + 1 times.
+  //
+  const Slot& slot = slots[frameNo % frameCapacity];
+  uint64_t expected = 2 * ((frameNo / frameCapacity) + 1);
+  if(slot._sequence.load(std::memory_order_acquire) != expected)
+    return false;
+
+  for(int phase = 0; phase < PHASE_COUNT; ++phase)
+    frame->_phaseNanoseconds[phase] = slot._phaseNanoseconds[phase].load(std::memory_order_relaxed);
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot._sequence.load(std::memory_order_relaxed) == expected;
+}
+
+void Profiler::clear()
+{
+  phaseStats.fill(PhaseStats{0, 0});
+  currentFrame._phaseNanoseconds.fill(0);
+  frameCount.store(0, std::memory_order_release);
+  for(auto& slot : slots)
+    slot._sequence.store(0, std::memory_order_relaxed);
+  for(auto& histogram : histograms){
+    histogram._buckets.fill(0);
+    histogram._minNanoseconds = 0;
+    histogram._totalNanoseconds = 0;
+    histogram._frameCount = 0;
+  }
+}
+
+void Profiler::drawOverlay(RenderBuffer& renderBuffer, int screenid)
+{
+  //
+  // the frame budget is drawn at this height (in pixels) above the bottom of the screen.
+  //
+  static constexpr int budgetHeight {64};
+
+  //
+  // the update phase contains the level update phases, only its remainder is drawn.
+  //
+  struct Segment
+  {
+    Phase _phase;
+    pxr::gfx::Color4u _color;
+  };
+
+  static const std::array<Segment, 5> segments {{
+    {PHASE_PROP_UPDATE, pxr::gfx::colors::green},
+    {PHASE_INTERACTION, pxr::gfx::colors::yellow},
+    {PHASE_PIXEL_TESTS, pxr::gfx::colors::red},
+    {PHASE_MARIO, pxr::gfx::colors::blue},
+    {PHASE_DRAW, pxr::gfx::colors::cyan}
+  }};
+
+  auto toPixels = [](int64_t nanoseconds){
+    return static_cast<int>((nanoseconds * budgetHeight) / frameBudgetNanoseconds);
+  };
+
+  uint64_t count = getFrameCount();
+  uint64_t columns = std::min<uint64_t>({count, frameCapacity, static_cast<uint64_t>(worldSize._x)});
+
+  pxr::iRect rect {};
+  rect._w = 1;
+  Frame frame {};
+  for(uint64_t column = 0; column < columns; ++column){
+    if(!getFrame(count - columns + column, &frame))
+      continue;
+    rect._x = column;
+
+    int64_t updateRemainder = frame._phaseNanoseconds[PHASE_UPDATE];
+    int64_t stacked {0};
+    for(const auto& segment : segments){
+      int64_t nanoseconds = frame._phaseNanoseconds[segment._phase];
+      if(segment._phase != PHASE_DRAW)
+        updateRemainder -= nanoseconds;
+      rect._y = toPixels(stacked);
+      stacked += nanoseconds;
+      rect._h = toPixels(stacked) - rect._y;
+      if(rect._h > 0)
+        renderBuffer.drawFillRectangle(rect, segment._color, screenid);
+    }
+
+    rect._y = toPixels(stacked);
+    rect._h = toPixels(stacked + std::max<int64_t>(0, updateRemainder)) - rect._y;
+    if(rect._h > 0)
+      renderBuffer.drawFillRectangle(rect, pxr::gfx::colors::magenta, screenid);
+  }
+
+  rect._x = 0;
+  rect._y = budgetHeight;
+  rect._w = worldSize._x;
+  rect._h = 1;
+  renderBuffer.drawFillRectangle(rect, pxr::gfx::colors::white, screenid);
+}
+
+void Profiler::logReport()
+{
+  pxr::log::log(pxr::log::INFO, msg_report_start);
+
+  for(int phase = 0; phase < PHASE_COUNT; ++phase){
+    const Histogram& histogram = histograms[phase];
+    if(histogram._frameCount == 0 || phaseStats[phase]._sampleCount == 0)
+      continue;
+
+    //
+    // p99 is the upper bound of the bucket containing the 99th percentile frame.
+    //
+    int64_t target = ((histogram._frameCount * 99) + 99) / 100;
+    int64_t cumulative {0};
+    int bucket {0};
+    for(; bucket < histogramBucketCount - 1; ++bucket){
+      cumulative += histogram._buckets[bucket];
+      if(cumulative >= target)
+        break;
+    }
+    int64_t p99 = (bucket + 1) * histogramBucketNanoseconds;
+
+    char buffer[128];
+    std::snprintf(buffer, sizeof(buffer), "%s: min %.1fus avg %.1fus p99 %s%.1fus",
+                  getPhaseName(static_cast<Phase>(phase)),
+                  histogram._minNanoseconds / 1e3,
+                  (static_cast<double>(histogram._totalNanoseconds) / histogram._frameCount) / 1e3,
+                  bucket == histogramBucketCount - 1 ? ">" : "",
+                  (bucket == histogramBucketCount - 1 ? bucket * histogramBucketNanoseconds : p99) / 1e3);
+
+    pxr::log::log(pxr::log::INFO, msg_report_phase, buffer);
+  }
+}
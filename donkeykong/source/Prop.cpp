@@ -1,7 +1,8 @@
 #include <cassert>
-#include "pixiretro/pxr_rand.h"
 #include "Prop.h"
 #include "AnimationFactory.h"
+#include "Random.h"
+#include "Trace.h"
 
 Prop::Prop(pxr::Vector2f position, std::shared_ptr<const Definition> def) :
   _def{def},
@@ -9,12 +10,15 @@ Prop::Prop(pxr::Vector2f position, std::shared_ptr<const Definition> def) :
   _stateClock{0.f},
   _animation{},
   _position{position},
-  _transition{}
+  _transition{},
+  _hotData{nullptr},
+  _hotIndex{-1}
 {
   assert(_def != nullptr);
   assert(_def->_states.size() >= 1);
   _isChangingStates = !(_def->_states.size() == 1);
-  transitionToState(0);
+  _isStatic = !_isChangingStates && (*(_def->_states[0]._positionPoints)).size() == 1;
+  transitionToState(0, false);
 }
 
 Prop::StateDefinition::StateDefinition(
@@ -23,6 +27,7 @@ Prop::StateDefinition::StateDefinition(
   std::vector<pxr::sfx::ResourceKey_t>                  sounds,
   pxr::fRect                                            interactionBox,
   std::string                                           animationName,
+  int                                                   animationHandle,
   float                                                 duration,
   float                                                 supportHeight,
   float                                                 ladderHeight,
@@ -38,6 +43,7 @@ Prop::StateDefinition::StateDefinition(
   _sounds{sounds},
   _interactionBox{interactionBox},
   _animationName{animationName},
+  _animationHandle{animationHandle},
   _duration{duration},
   _supportHeight{supportHeight},
   _ladderHeight{ladderHeight},
@@ -52,6 +58,7 @@ Prop::StateDefinition::StateDefinition(
   assert((*_speedPoints).size() >= 1);
   assert(_interactionBox._w >= 0 && _interactionBox._h >= 0);
   assert(_animationName.size() > 0);
+  assert(_animationHandle >= 0);
 }
 
 Prop::Definition::Definition(
@@ -75,9 +82,15 @@ void Prop::onUpdate(double now, float dt)
   _animation.onUpdate(dt);
   _transition.onUpdate(dt);
 
-  if(!_isChangingStates)
-    return;
+  if(_isChangingStates)
+    updateState(dt);
+
+  if(!_isStatic)
+    syncHotData();
+}
 
+void Prop::updateState(float dt)
+{
   _stateClock += dt;
   if(_stateClock < _def->_states[_currentState]._duration)
     return;
@@ -90,7 +103,7 @@ void Prop::onUpdate(double now, float dt)
         newState = 0;
       break;
     case StateTransitionMode::RANDOM:
-      newState = pxr::rand::uniformSignedInt(0, _def->_states.size() - 1);
+      newState = Random::uniformSignedInt(0, _def->_states.size() - 1);
       break;
   }
   transitionToState(newState);
@@ -102,9 +115,41 @@ void Prop::reset()
   transitionToState(0);
 }
 
-void Prop::onDraw(int screenid)
+Prop::Snapshot Prop::getSnapshot() const
+{
+  return Snapshot{_currentState, _stateClock, _animation.getSnapshot(), _transition.getSnapshot()};
+}
+
+void Prop::restore(const Snapshot& snapshot)
+{
+  assert(0 <= snapshot._currentState && snapshot._currentState < static_cast<int>(_def->_states.size()));
+
+  //
+  // only props which changed state since the snapshot need their state's shared data back.
+  //
+  if(_currentState != snapshot._currentState){
+    const auto& stateDef = _def->_states[snapshot._currentState];
+    _animation = AnimationFactory::makeAnimation(stateDef._animationHandle);
+    _transition.reset(stateDef._positionPoints, stateDef._speedPoints);
+    _currentState = snapshot._currentState;
+  }
+
+  _stateClock = snapshot._stateClock;
+  _animation.restore(snapshot._animation);
+  _transition.restore(snapshot._transition);
+}
+
+void Prop::redefine()
 {
-  _animation.onDraw(_position + _transition.getPosition(), screenid);
+  _isChangingStates = !(_def->_states.size() == 1);
+  _isStatic = !_isChangingStates && (*(_def->_states[0]._positionPoints)).size() == 1;
+  int state = _currentState < static_cast<int>(_def->_states.size()) ? _currentState : 0;
+  transitionToState(state, false);
+}
+
+void Prop::onDraw(DrawList& drawList)
+{
+  _animation.onDraw(_position + _transition.getPosition(), _def->_drawLayer, drawList);
 }
 
 bool Prop::isSupport() const
@@ -181,19 +226,76 @@ pxr::gfx::SpriteId_t Prop::getSpriteId() const
   return _animation.getSpriteId();
 }
 
-void Prop::transitionToState(int state)
+const SpriteMask& Prop::getSpriteMask() const
+{
+  return _animation.getSpriteMask();
+}
+
+bool Prop::isMirroringX() const
+{
+  return _animation.isMirroringX();
+}
+
+bool Prop::isMirroringY() const
+{
+  return _animation.isMirroringY();
+}
+
+void Prop::transitionToState(int state, bool isPlayingSounds)
 {
   assert(0 <= state && state < _def->_states.size());
   const auto& stateDef = _def->_states[state];
   _stateClock = 0.f;
-  _animation = AnimationFactory::makeAnimation(stateDef._animationName);
+  _animation = AnimationFactory::makeAnimation(stateDef._animationHandle);
   _transition.reset(stateDef._positionPoints, stateDef._speedPoints);
   _currentState = state;
 
+  syncHotData();
+
+  Trace::instantEvent("prop state transition", _def->_name.c_str(), state);
+
   //
   // Play all state entry sounds.
   //
-  for(auto soundKey : _def->_states[state]._sounds)
-    pxr::sfx::playSound(soundKey);
+  if(isPlayingSounds)
+    for(auto soundKey : _def->_states[state]._sounds)
+      pxr::sfx::playSound(soundKey);
 }
 
+
+void Prop::bindHotData(PropHotData* hotData, int hotIndex)
+{
+  assert(hotData != nullptr);
+  assert(0 <= hotIndex && hotIndex < hotData->size());
+  _hotData = hotData;
+  _hotIndex = hotIndex;
+  syncHotData();
+}
+
+void Prop::syncHotData()
+{
+  if(_hotData == nullptr)
+    return;
+
+  const auto& stateDef = _def->_states[_currentState];
+
+  pxr::Vector2f position = getPosition();
+  _hotData->_positionX[_hotIndex] = position._x;
+  _hotData->_positionY[_hotIndex] = position._y;
+
+  pxr::AABB box = getInteractionBox();
+  _hotData->_boxXMin[_hotIndex] = box._xmin;
+  _hotData->_boxXMax[_hotIndex] = box._xmax;
+  _hotData->_boxYMin[_hotIndex] = box._ymin;
+  _hotData->_boxYMax[_hotIndex] = box._ymax;
+
+  uint8_t effects {0};
+  if(stateDef._isSupport) effects |= PropHotData::EFFECT_SUPPORT;
+  if(stateDef._isLadder) effects |= PropHotData::EFFECT_LADDER;
+  if(stateDef._isConveyor) effects |= PropHotData::EFFECT_CONVEYOR;
+  if(stateDef._isKiller) effects |= PropHotData::EFFECT_KILLER;
+  _hotData->_effects[_hotIndex] = effects;
+
+  _hotData->_currentState[_hotIndex] = _currentState;
+  _hotData->_stateClock[_hotIndex] = _stateClock;
+}
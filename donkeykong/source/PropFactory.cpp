@@ -2,6 +2,10 @@
 #include <cstring>
 #include <cassert>
 #include "PropFactory.h"
+#include "AnimationFactory.h"
+#include "AssetPack.h"
+#include "ResourceCache.h"
+#include "Trace.h"
 #include "pixiretro/pxr_log.h"
 #include "pixiretro/pxr_xml.h"
 
@@ -17,6 +21,7 @@ static constexpr const char* msg_load_abort = "aborting prop definitions load du
 static constexpr const char* msg_load_success = "success loading prop definitions file";
 static constexpr const char* msg_empty_prop_name = "read empty prop name";
 static constexpr const char* msg_empty_sound_name = "read empty sound name";
+static constexpr const char* msg_load_pack = "loading prop definitions from asset pack";
 
 bool PropFactory::initialize()
 {
@@ -25,6 +30,8 @@ bool PropFactory::initialize()
 
   instance = std::unique_ptr<PropFactory>{new PropFactory()};
   assert(instance != nullptr);
+  if(AssetPack::isOpen())
+    return instance->loadPackedPropDefinitions();
   return instance->loadPropDefinitions();
 }
 
@@ -33,20 +40,163 @@ void PropFactory::shutdown()
   if(instance == nullptr)
     return;
 
-  for(auto& pair : instance->_defs)
-    for(auto& state : pair.second->_states)
-      for(auto& sound : state._sounds)
-        pxr::sfx::unloadSound(sound);
+  for(auto& pair : instance->_soundKeys)
+    ResourceCache::releaseSound(pair.first);
 
   instance.reset();
 }
 
-Prop PropFactory::makeProp(pxr::Vector2f position, const std::string& propName)
+bool PropFactory::reload()
 {
   assert(instance != nullptr);
-  auto search = instance->_defs.find(propName);
-  assert(search != instance->_defs.end());
-  return Prop{position, search->second};
+
+  auto loadedHandles = std::move(instance->_handles);
+  auto loadedDefs = std::move(instance->_defs);
+  instance->_handles.clear();
+  instance->_defs.clear();
+
+  bool isLoaded = instance->loadPropDefinitions();
+
+  std::swap(loadedHandles, instance->_handles);
+  std::swap(loadedDefs, instance->_defs);
+
+  if(!isLoaded)
+    return false;
+
+  //
+  // patch the existing definitions in place, so the props which share them see the change
+  // and handles stay valid; definitions no longer in the file are kept as levels may still
+  // use them.
+  //
+  for(const auto& pair : loadedHandles){
+    auto search = instance->_handles.find(pair.first);
+    if(search != instance->_handles.end())
+      *(instance->_defs[search->second]) = std::move(*(loadedDefs[pair.second]));
+    else
+      instance->addDefinition(pair.first, loadedDefs[pair.second]);
+  }
+
+  return true;
+}
+
+int PropFactory::findDefinition(const std::string& propName)
+{
+  assert(instance != nullptr);
+  auto search = instance->_handles.find(propName);
+  return search != instance->_handles.end() ? search->second : -1;
+}
+
+Prop PropFactory::makeProp(pxr::Vector2f position, int handle)
+{
+  TraceScope scope {"PropFactory::makeProp"};
+  assert(instance != nullptr);
+  assert(0 <= handle && handle < static_cast<int>(instance->_defs.size()));
+  return Prop{position, instance->_defs[handle]};
+}
+
+pxr::sfx::ResourceKey_t PropFactory::loadSound(const char* soundName)
+{
+  auto search = _soundKeys.find(soundName);
+  if(search == _soundKeys.end())
+    search = _soundKeys.emplace(soundName, ResourceCache::acquireSound(soundName)).first;
+  return search->second;
+}
+
+void PropFactory::addDefinition(const std::string& propName, std::shared_ptr<Prop::Definition> def)
+{
+  if(!_handles.emplace(propName, static_cast<int>(_defs.size())).second)
+    return;
+  _defs.push_back(std::move(def));
+}
+
+bool PropFactory::loadPackedPropDefinitions()
+{
+  assert(_defs.size() == 0);
+  assert(AssetPack::isOpen());
+
+  pxr::log::log(pxr::log::INFO, msg_load_pack);
+
+  auto onerror = [](){
+    pxr::log::log(pxr::log::ERROR, msg_load_abort);
+    return false;
+  };
+
+  uint32_t defCount {0};
+  const auto* defs = AssetPack::getRecords<pack::PropDefinition>(pack::SECTION_PROP_DEFINITIONS, &defCount);
+  const auto* states = AssetPack::getRecords<pack::State>(pack::SECTION_STATES);
+  const auto* points = AssetPack::getRecords<pack::Point>(pack::SECTION_POINTS);
+  const auto* speeds = AssetPack::getRecords<pack::SpeedPoint>(pack::SECTION_SPEED_POINTS);
+  const auto* soundNames = AssetPack::getRecords<uint32_t>(pack::SECTION_SOUND_NAMES);
+
+  _defs.reserve(defCount);
+
+  for(uint32_t d = 0; d < defCount; ++d){
+    const pack::PropDefinition& pdef = defs[d];
+
+    std::vector<Prop::StateDefinition> stateDefs {};
+    stateDefs.reserve(pdef._states._count);
+
+    for(uint32_t s = pdef._states._first; s < pdef._states._first + pdef._states._count; ++s){
+      const pack::State& state = states[s];
+
+      auto positions = std::make_shared<std::vector<pxr::Vector2f>>();
+      positions->reserve(state._positions._count);
+      for(uint32_t p = state._positions._first; p < state._positions._first + state._positions._count; ++p)
+        positions->push_back(pxr::Vector2f{points[p]._x, points[p]._y});
+
+      auto speedPoints = std::make_shared<std::vector<Transition::SpeedPoint>>();
+      speedPoints->reserve(state._speeds._count);
+      for(uint32_t p = state._speeds._first; p < state._speeds._first + state._speeds._count; ++p)
+        speedPoints->push_back(Transition::SpeedPoint{speeds[p]._value, speeds[p]._duration});
+
+      std::vector<pxr::sfx::ResourceKey_t> sounds {};
+      for(uint32_t n = state._sounds._first; n < state._sounds._first + state._sounds._count; ++n)
+        sounds.push_back(loadSound(AssetPack::getString(soundNames[n])));
+
+      const char* animationName = AssetPack::getString(state._animationName);
+      int animationHandle = AnimationFactory::findAnimation(animationName);
+      if(animationHandle < 0) return onerror();
+
+      pxr::fRect interactionBox {};
+      interactionBox._x = state._boxX;
+      interactionBox._y = state._boxY;
+      interactionBox._w = state._boxW;
+      interactionBox._h = state._boxH;
+
+      stateDefs.emplace_back(
+        positions,
+        speedPoints,
+        sounds,
+        interactionBox,
+        animationName,
+        animationHandle,
+        state._duration,
+        state._supportHeight,
+        state._ladderHeight,
+        pxr::Vector2f{state._conveyorVelocityX, state._conveyorVelocityY},
+        state._killerDamage,
+        (state._flags & pack::FLAG_SUPPORT) != 0,
+        (state._flags & pack::FLAG_LADDER) != 0,
+        (state._flags & pack::FLAG_CONVEYOR) != 0,
+        (state._flags & pack::FLAG_KILLER) != 0
+      );
+    }
+
+    std::string propName {AssetPack::getString(pdef._name)};
+    std::shared_ptr<Prop::Definition> def {new Prop::Definition{
+      propName,
+      pdef._stateTransitionMode == pack::TRANSITION_RANDOM ? Prop::StateTransitionMode::RANDOM :
+                                                             Prop::StateTransitionMode::FORWARD,
+      std::move(stateDefs),
+      pdef._drawLayer
+    }};
+
+    addDefinition(propName, std::move(def));
+  }
+
+  pxr::log::log(pxr::log::INFO, msg_load_success);
+
+  return true;
 }
 
 bool PropFactory::loadPropDefinitions()
@@ -217,7 +367,7 @@ bool PropFactory::loadPropDefinitions()
           continue;
         }
         if(std::strcmp(soundName, "NA") != 0){
-          sounds.push_back(pxr::sfx::loadSound(soundName));
+          sounds.push_back(loadSound(soundName));
         }
         xmlsound = xmlsound->NextSiblingElement("sound");
       }
@@ -230,6 +380,8 @@ bool PropFactory::loadPropDefinitions()
       const char* animationName;
       if(!pxr::io::extractChildElement(xmlstate, &xmlanimation, "animation")) return onerror();
       if(!pxr::io::extractStringAttribute(xmlanimation, "name", &animationName)) return onerror();
+      int animationHandle = AnimationFactory::findAnimation(animationName);
+      if(animationHandle < 0) return onerror();
 
       //
       // Construct the state instance.
@@ -240,6 +392,7 @@ bool PropFactory::loadPropDefinitions()
         sounds,
         interactionBox,
         animationName,
+        animationHandle,
         stateDuration,
         supportHeight,
         ladderHeight,
@@ -264,10 +417,7 @@ bool PropFactory::loadPropDefinitions()
       drawLayer
     }};
 
-    _defs.emplace(std::make_pair(
-      std::string{propName},
-      def
-    ));
+    addDefinition(propName, std::move(def));
 
     xmlprop = xmlprop->NextSiblingElement("prop");
   }
@@ -0,0 +1,113 @@
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include "PropGrid.h"
+
+PropGrid::PropGrid() :
+  _cells{},
+  _spans{},
+  _queryStamps{},
+  _queryStamp{0}
+{}
+
+bool PropGrid::CellSpan::operator==(const CellSpan& other) const
+{
+  return _colMin == other._colMin && _colMax == other._colMax &&
+         _rowMin == other._rowMin && _rowMax == other._rowMax;
+}
+
+void PropGrid::clear()
+{
+  for(auto& cell : _cells)
+    cell.clear();
+  _spans.clear();
+  _queryStamps.clear();
+  _queryStamp = 0;
+}
+
+void PropGrid::insert(int propIndex, const pxr::AABB& box)
+{
+  assert(propIndex == static_cast<int>(_spans.size()));
+  CellSpan span = computeSpan(box);
+  _spans.push_back(span);
+  _queryStamps.push_back(0);
+  addToCells(propIndex, span);
+}
+
+void PropGrid::update(int propIndex, const pxr::AABB& box)
+{
+  assert(0 <= propIndex && propIndex < static_cast<int>(_spans.size()));
+  CellSpan span = computeSpan(box);
+  if(span == _spans[propIndex])
+    return;
+
+  removeFromCells(propIndex, _spans[propIndex]);
+  addToCells(propIndex, span);
+  _spans[propIndex] = span;
+}
+
+void PropGrid::query(const pxr::AABB& box, std::vector<int>& propIndices)
+{
+  propIndices.clear();
+
+  //
+  // reset all stamps upon wrap around else stale stamps could match the new stamp.
+  //
+  ++_queryStamp;
+  if(_queryStamp == 0){
+    std::fill(_queryStamps.begin(), _queryStamps.end(), 0);
+    _queryStamp = 1;
+  }
+
+  CellSpan span = computeSpan(box);
+  for(int row = span._rowMin; row <= span._rowMax; ++row){
+    for(int col = span._colMin; col <= span._colMax; ++col){
+      for(int propIndex : _cells[(row * columnCount) + col]){
+        if(_queryStamps[propIndex] == _queryStamp)
+          continue;
+        _queryStamps[propIndex] = _queryStamp;
+        propIndices.push_back(propIndex);
+      }
+    }
+  }
+
+  //
+  // sorted to preserve the order in which the props are stored in the level.
+  //
+  std::sort(propIndices.begin(), propIndices.end());
+}
+
+PropGrid::CellSpan PropGrid::computeSpan(const pxr::AABB& box) const
+{
+  auto toCell = [](float position, int cellCount){
+    int cell = static_cast<int>(std::floor(position / cellSize));
+    return std::clamp(cell, 0, cellCount - 1);
+  };
+
+  CellSpan span {};
+  span._colMin = toCell(box._xmin, columnCount);
+  span._colMax = toCell(box._xmax, columnCount);
+  span._rowMin = toCell(box._ymin, rowCount);
+  span._rowMax = toCell(box._ymax, rowCount);
+  return span;
+}
+
+void PropGrid::addToCells(int propIndex, const CellSpan& span)
+{
+  for(int row = span._rowMin; row <= span._rowMax; ++row)
+    for(int col = span._colMin; col <= span._colMax; ++col)
+      _cells[(row * columnCount) + col].push_back(propIndex);
+}
+
+void PropGrid::removeFromCells(int propIndex, const CellSpan& span)
+{
+  for(int row = span._rowMin; row <= span._rowMax; ++row){
+    for(int col = span._colMin; col <= span._colMax; ++col){
+      auto& cell = _cells[(row * columnCount) + col];
+      auto search = std::find(cell.begin(), cell.end(), propIndex);
+      assert(search != cell.end());
+      *search = cell.back();
+      cell.pop_back();
+    }
+  }
+}
@@ -0,0 +1,28 @@
+#include "PropHotData.h"
+
+int PropHotData::add()
+{
+  _positionX.push_back(0.f);
+  _positionY.push_back(0.f);
+  _boxXMin.push_back(0.f);
+  _boxXMax.push_back(0.f);
+  _boxYMin.push_back(0.f);
+  _boxYMax.push_back(0.f);
+  _effects.push_back(0);
+  _currentState.push_back(0);
+  _stateClock.push_back(0.f);
+  return size() - 1;
+}
+
+void PropHotData::clear()
+{
+  _positionX.clear();
+  _positionY.clear();
+  _boxXMin.clear();
+  _boxXMax.clear();
+  _boxYMin.clear();
+  _boxYMax.clear();
+  _effects.clear();
+  _currentState.clear();
+  _stateClock.clear();
+}
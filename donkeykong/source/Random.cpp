@@ -0,0 +1,41 @@
+#include <random>
+#include "Random.h"
+
+//
+// xorshift64*; the state must be non-zero.
+//
+static constexpr uint64_t fallbackSeed {0x9e3779b97f4a7c15};
+
+static uint64_t state {Random::makeSeed()};
+
+static uint64_t nextRandom()
+{
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 0x2545f4914f6cdd1d;
+}
+
+void Random::seed(uint64_t seed)
+{
+  state = seed != 0 ? seed : fallbackSeed;
+}
+
+uint64_t Random::makeSeed()
+{
+  std::random_device device {};
+  uint64_t seed = (static_cast<uint64_t>(device()) << 32) | device();
+  return seed != 0 ? seed : fallbackSeed;
+}
+
+int Random::uniformSignedInt(int lo, int hi)
+{
+  uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(hi) - lo) + 1;
+  return static_cast<int>(lo + static_cast<int64_t>(nextRandom() % range));
+}
+
+unsigned Random::uniformUnsignedInt(unsigned lo, unsigned hi)
+{
+  uint64_t range = static_cast<uint64_t>(hi - lo) + 1;
+  return lo + static_cast<unsigned>(nextRandom() % range);
+}
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <cassert>
+#include "Rasterizer.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+  #define DK_RASTERIZER_SSE2
+  #include <emmintrin.h>
+  #if defined(__GNUC__)
+    #define DK_RASTERIZER_AVX2
+    #include <immintrin.h>
+  #endif
+#endif
+
+static uint32_t packColor(pxr::gfx::Color4u color)
+{
+  return static_cast<uint32_t>(color._r) |
+         (static_cast<uint32_t>(color._g) << 8) |
+         (static_cast<uint32_t>(color._b) << 16) |
+         (static_cast<uint32_t>(color._a) << 24);
+}
+
+//
+// The row blits copy the opaque pixels of src[0, count) to dst[0, count); if isReversed src
+// is read from right to left, i.e. dst[i] = src[count - 1 - i]. Each blits what it can in
+// whole vectors and finishes with the scalar blit from 'i'.
+//
+using BlitRow_t = void (*)(uint32_t*, const uint32_t*, int, bool);
+
+//
+// SCALAR ////////////////////////////////////////////////////////////////////////////////////////
+//
+
+static inline void scalarBlitRowFrom(uint32_t* dst, const uint32_t* src, int count, bool isReversed, int i)
+{
+  for(; i < count; ++i){
+    uint32_t pixel = isReversed ? src[count - 1 - i] : src[i];
+    if((pixel >> 24) != 0)
+      dst[i] = pixel;
+  }
+}
+
+[[maybe_unused]]
+static void scalarBlitRow(uint32_t* dst, const uint32_t* src, int count, bool isReversed)
+{
+  scalarBlitRowFrom(dst, src, count, isReversed, 0);
+}
+
+//
+// SSE2 //////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#ifdef DK_RASTERIZER_SSE2
+
+static inline int sse2BlitRowFrom(uint32_t* dst, const uint32_t* src, int count, bool isReversed, int i)
+{
+  const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xff000000));
+  const __m128i zero = _mm_setzero_si128();
+  for(; i + 4 <= count; i += 4){
+    const uint32_t* s = isReversed ? src + count - i - 4 : src + i;
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    if(isReversed)
+      pixels = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(0, 1, 2, 3));
+    __m128i isTransparent = _mm_cmpeq_epi32(_mm_and_si128(pixels, alphaMask), zero);
+    __m128i old = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    __m128i out = _mm_or_si128(_mm_and_si128(isTransparent, old), _mm_andnot_si128(isTransparent, pixels));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+  }
+  return i;
+}
+
+static void sse2BlitRow(uint32_t* dst, const uint32_t* src, int count, bool isReversed)
+{
+  int i = sse2BlitRowFrom(dst, src, count, isReversed, 0);
+  scalarBlitRowFrom(dst, src, count, isReversed, i);
+}
+
+#endif
+
+//
+// AVX2 //////////////////////////////////////////////////////////////////////////////////////////
+//
+
+#ifdef DK_RASTERIZER_AVX2
+
+__attribute__((target("avx2")))
+static void avx2BlitRow(uint32_t* dst, const uint32_t* src, int count, bool isReversed)
+{
+  const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xff000000));
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i reverse = _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  int i {0};
+  for(; i + 8 <= count; i += 8){
+    const uint32_t* s = isReversed ? src + count - i - 8 : src + i;
+    __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    if(isReversed)
+      pixels = _mm256_permutevar8x32_epi32(pixels, reverse);
+    __m256i isTransparent = _mm256_cmpeq_epi32(_mm256_and_si256(pixels, alphaMask), zero);
+    __m256i old = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    __m256i out = _mm256_blendv_epi8(pixels, old, isTransparent);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+  }
+  i = sse2BlitRowFrom(dst, src, count, isReversed, i);
+  scalarBlitRowFrom(dst, src, count, isReversed, i);
+}
+
+#endif
+
+//
+// DISPATCH //////////////////////////////////////////////////////////////////////////////////////
+//
+
+static BlitRow_t selectBlitRow()
+{
+#ifdef DK_RASTERIZER_AVX2
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2"))
+    return avx2BlitRow;
+#endif
+#ifdef DK_RASTERIZER_SSE2
+  return sse2BlitRow;
+#else
+  return scalarBlitRow;
+#endif
+}
+
+static BlitRow_t getBlitRow()
+{
+  static const BlitRow_t blitRow {selectBlitRow()};
+  return blitRow;
+}
+
+Rasterizer::Rasterizer() :
+  _screens{},
+  _spritesheets{}
+{}
+
+int Rasterizer::createScreen(pxr::Vector2i size)
+{
+  assert(size._x > 0 && size._y > 0);
+  Screen screen {};
+  screen._size = size;
+  screen._pixels.resize(static_cast<size_t>(size._x) * size._y, 0);
+  _screens.push_back(std::move(screen));
+  return _screens.size() - 1;
+}
+
+void Rasterizer::addSpritesheet(pxr::gfx::ResourceKey_t key, std::shared_ptr<const SpritesheetData> data)
+{
+  assert(data != nullptr);
+  _spritesheets[key] = std::move(data);
+}
+
+void Rasterizer::removeSpritesheet(pxr::gfx::ResourceKey_t key)
+{
+  _spritesheets.erase(key);
+}
+
+void Rasterizer::clearScreenShade(int shade, int screenid)
+{
+  assert(0 <= screenid && screenid < static_cast<int>(_screens.size()));
+  uint32_t value = static_cast<uint32_t>(std::clamp(shade, 0, 255));
+  uint32_t pixel = value | (value << 8) | (value << 16) | 0xff000000;
+  auto& pixels = _screens[screenid]._pixels;
+  std::fill(pixels.begin(), pixels.end(), pixel);
+}
+
+void Rasterizer::clearScreenTransparent(int screenid)
+{
+  assert(0 <= screenid && screenid < static_cast<int>(_screens.size()));
+  auto& pixels = _screens[screenid]._pixels;
+  std::fill(pixels.begin(), pixels.end(), 0);
+}
+
+void Rasterizer::drawSprite(pxr::Vector2i position, pxr::gfx::ResourceKey_t spritesheetKey,
+                            pxr::gfx::SpriteId_t spriteid, int screenid, bool mirrorX, bool mirrorY)
+{
+  assert(0 <= screenid && screenid < static_cast<int>(_screens.size()));
+
+  auto search = _spritesheets.find(spritesheetKey);
+  if(search == _spritesheets.end())
+    return;
+
+  const SpritesheetData& sheet = *search->second;
+  if(spriteid < 0 || spriteid >= static_cast<int>(sheet._sprites.size()))
+    return;
+
+  const SpritesheetData::Sprite& sprite = sheet._sprites[spriteid];
+  Screen& screen = _screens[screenid];
+
+  //
+  // the sprite rect in screen space, clipped to the screen.
+  //
+  int x0 = position._x - sprite._ox;
+  int y0 = position._y - sprite._oy;
+  int colBegin = std::max(x0, 0);
+  int colEnd = std::min(x0 + sprite._w, screen._size._x);
+  int rowBegin = std::max(y0, 0);
+  int rowEnd = std::min(y0 + sprite._h, screen._size._y);
+  if(colBegin >= colEnd || rowBegin >= rowEnd)
+    return;
+
+  BlitRow_t blitRow = getBlitRow();
+  int count = colEnd - colBegin;
+  for(int row = rowBegin; row < rowEnd; ++row){
+    int spriteRow = row - y0;
+    if(mirrorY)
+      spriteRow = sprite._h - 1 - spriteRow;
+
+    //
+    // the first source column; mirrored rows are read right to left starting from the
+    // column which lands on colEnd - 1.
+    //
+    int spriteCol = mirrorX ? sprite._w - (colEnd - x0) : colBegin - x0;
+
+    const uint32_t* src = &sheet._pixels[((sprite._y + spriteRow) * sheet._width) + sprite._x + spriteCol];
+    uint32_t* dst = &screen._pixels[(row * screen._size._x) + colBegin];
+    blitRow(dst, src, count, mirrorX);
+  }
+}
+
+void Rasterizer::fillRow(Screen& screen, int row, int colBegin, int colEnd, uint32_t pixel)
+{
+  if(row < 0 || row >= screen._size._y)
+    return;
+  colBegin = std::max(colBegin, 0);
+  colEnd = std::min(colEnd, screen._size._x);
+  if(colBegin >= colEnd)
+    return;
+  uint32_t* first = &screen._pixels[row * screen._size._x];
+  std::fill(first + colBegin, first + colEnd, pixel);
+}
+
+void Rasterizer::drawFillRectangle(const pxr::iRect& rect, pxr::gfx::Color4u color, int screenid)
+{
+  assert(0 <= screenid && screenid < static_cast<int>(_screens.size()));
+  Screen& screen = _screens[screenid];
+  uint32_t pixel = packColor(color);
+  for(int row = rect._y; row < rect._y + rect._h; ++row)
+    fillRow(screen, row, rect._x, rect._x + rect._w, pixel);
+}
+
+void Rasterizer::drawBorderRectangle(const pxr::iRect& rect, pxr::gfx::Color4u color, int screenid)
+{
+  assert(0 <= screenid && screenid < static_cast<int>(_screens.size()));
+  if(rect._w <= 0 || rect._h <= 0)
+    return;
+
+  Screen& screen = _screens[screenid];
+  uint32_t pixel = packColor(color);
+  fillRow(screen, rect._y, rect._x, rect._x + rect._w, pixel);
+  fillRow(screen, rect._y + rect._h - 1, rect._x, rect._x + rect._w, pixel);
+  for(int row = rect._y + 1; row < rect._y + rect._h - 1; ++row){
+    fillRow(screen, row, rect._x, rect._x + 1, pixel);
+    fillRow(screen, row, rect._x + rect._w - 1, rect._x + rect._w, pixel);
+  }
+}
+
+void Rasterizer::execute(const RenderBuffer& renderBuffer)
+{
+  pxr::iRect rect {};
+  for(const auto& command : renderBuffer.getCommands()){
+    switch(command._type){
+      case RenderCommand::RENDER_SPRITE:
+        drawSprite(command._position, command._a, command._b, command._screenid,
+                   command._mirrorX, command._mirrorY);
+        break;
+      case RenderCommand::RENDER_FILL_RECTANGLE:
+      case RenderCommand::RENDER_BORDER_RECTANGLE:
+        rect._x = command._position._x;
+        rect._y = command._position._y;
+        rect._w = command._a;
+        rect._h = command._b;
+        if(command._type == RenderCommand::RENDER_FILL_RECTANGLE)
+          drawFillRectangle(rect, command._color, command._screenid);
+        else
+          drawBorderRectangle(rect, command._color, command._screenid);
+        break;
+      case RenderCommand::RENDER_CLEAR_SHADE:
+        clearScreenShade(command._a, command._screenid);
+        break;
+      case RenderCommand::RENDER_CLEAR_TRANSPARENT:
+        clearScreenTransparent(command._screenid);
+        break;
+      case RenderCommand::RENDER_TEXT:
+        break;
+    }
+  }
+}
+
+const Rasterizer::Screen& Rasterizer::getScreen(int screenid) const
+{
+  assert(0 <= screenid && screenid < static_cast<int>(_screens.size()));
+  return _screens[screenid];
+}
+
+void Rasterizer::composite(std::vector<uint32_t>& pixels) const
+{
+  pixels.clear();
+  if(_screens.empty())
+    return;
+
+  pixels.resize(_screens[0]._pixels.size(), 0);
+  for(const auto& screen : _screens){
+    assert(screen._pixels.size() == pixels.size());
+    getBlitRow()(pixels.data(), screen._pixels.data(), pixels.size(), false);
+  }
+}
@@ -0,0 +1,121 @@
+#include <cassert>
+#include "RenderBuffer.h"
+
+RenderBuffer::RenderBuffer() :
+  _commands{},
+  _text{}
+{}
+
+void RenderBuffer::clear()
+{
+  _commands.clear();
+  _text.clear();
+}
+
+void RenderBuffer::drawSprite(pxr::Vector2i position, pxr::gfx::ResourceKey_t spritesheetKey,
+                              pxr::gfx::SpriteId_t spriteid, int screenid, bool mirrorX, bool mirrorY)
+{
+  RenderCommand command {};
+  command._type = RenderCommand::RENDER_SPRITE;
+  command._screenid = screenid;
+  command._position = position;
+  command._a = spritesheetKey;
+  command._b = spriteid;
+  command._mirrorX = mirrorX;
+  command._mirrorY = mirrorY;
+  _commands.push_back(command);
+}
+
+void RenderBuffer::drawFillRectangle(const pxr::iRect& rect, pxr::gfx::Color4u color, int screenid)
+{
+  RenderCommand command {};
+  command._type = RenderCommand::RENDER_FILL_RECTANGLE;
+  command._screenid = screenid;
+  command._position = pxr::Vector2i{rect._x, rect._y};
+  command._a = rect._w;
+  command._b = rect._h;
+  command._color = color;
+  _commands.push_back(command);
+}
+
+void RenderBuffer::drawBorderRectangle(const pxr::iRect& rect, pxr::gfx::Color4u color, int screenid)
+{
+  RenderCommand command {};
+  command._type = RenderCommand::RENDER_BORDER_RECTANGLE;
+  command._screenid = screenid;
+  command._position = pxr::Vector2i{rect._x, rect._y};
+  command._a = rect._w;
+  command._b = rect._h;
+  command._color = color;
+  _commands.push_back(command);
+}
+
+void RenderBuffer::clearScreenShade(int shade, int screenid)
+{
+  RenderCommand command {};
+  command._type = RenderCommand::RENDER_CLEAR_SHADE;
+  command._screenid = screenid;
+  command._a = shade;
+  _commands.push_back(command);
+}
+
+void RenderBuffer::clearScreenTransparent(int screenid)
+{
+  RenderCommand command {};
+  command._type = RenderCommand::RENDER_CLEAR_TRANSPARENT;
+  command._screenid = screenid;
+  _commands.push_back(command);
+}
+
+void RenderBuffer::drawText(pxr::Vector2i position, const std::string& text,
+                            pxr::gfx::ResourceKey_t fontKey, int screenid)
+{
+  RenderCommand command {};
+  command._type = RenderCommand::RENDER_TEXT;
+  command._screenid = screenid;
+  command._position = position;
+  command._a = fontKey;
+  command._textOffset = _text.size();
+  command._textLength = text.size();
+  _text += text;
+  _commands.push_back(command);
+}
+
+std::string RenderBuffer::getText(const RenderCommand& command) const
+{
+  assert(command._type == RenderCommand::RENDER_TEXT);
+  return _text.substr(command._textOffset, command._textLength);
+}
+
+void RenderBuffer::execute() const
+{
+  pxr::iRect rect {};
+  for(const auto& command : _commands){
+    switch(command._type){
+      case RenderCommand::RENDER_SPRITE:
+        pxr::gfx::drawSprite(command._position, command._a, command._b, command._screenid,
+                             command._mirrorX, command._mirrorY);
+        break;
+      case RenderCommand::RENDER_FILL_RECTANGLE:
+      case RenderCommand::RENDER_BORDER_RECTANGLE:
+        rect._x = command._position._x;
+        rect._y = command._position._y;
+        rect._w = command._a;
+        rect._h = command._b;
+        if(command._type == RenderCommand::RENDER_FILL_RECTANGLE)
+          pxr::gfx::drawFillRectangle(rect, command._color, command._screenid);
+        else
+          pxr::gfx::drawBorderRectangle(rect, command._color, command._screenid);
+        break;
+      case RenderCommand::RENDER_CLEAR_SHADE:
+        pxr::gfx::clearScreenShade(command._a, command._screenid);
+        break;
+      case RenderCommand::RENDER_CLEAR_TRANSPARENT:
+        pxr::gfx::clearScreenTransparent(command._screenid);
+        break;
+      case RenderCommand::RENDER_TEXT:
+        pxr::gfx::drawText(command._position, getText(command), command._a, command._screenid);
+        break;
+    }
+  }
+}
@@ -0,0 +1,155 @@
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include "pixiretro/pxr_log.h"
+#include "ResourceCache.h"
+
+std::unique_ptr<ResourceCache> ResourceCache::instance {nullptr};
+
+//
+// log strings.
+//
+static constexpr const char* msg_report_start = "resource cache (refs, bytes)";
+static constexpr const char* msg_report_spritesheet = "cached spritesheet";
+static constexpr const char* msg_report_sound = "cached sound";
+static constexpr const char* msg_report_total = "resource cache total bytes";
+static constexpr const char* msg_release_unknown = "released resource not in the cache";
+
+static int64_t getFileSize(const std::string& path)
+{
+  std::error_code error {};
+  auto size = std::filesystem::file_size(path, error);
+  return error ? 0 : static_cast<int64_t>(size);
+}
+
+bool ResourceCache::initialize()
+{
+  if(instance != nullptr)
+    return true;
+
+  instance = std::unique_ptr<ResourceCache>{new ResourceCache()};
+  assert(instance != nullptr);
+  return true;
+}
+
+void ResourceCache::shutdown()
+{
+  if(instance == nullptr)
+    return;
+
+  for(auto& pair : instance->_spritesheets)
+    pxr::gfx::unloadSpritesheet(pair.second._key);
+
+  for(auto& pair : instance->_sounds)
+    pxr::sfx::unloadSound(pair.second._key);
+
+  instance.reset();
+}
+
+pxr::gfx::ResourceKey_t ResourceCache::acquireSpritesheet(const std::string& name)
+{
+  assert(instance != nullptr);
+  auto search = instance->_spritesheets.find(name);
+  if(search == instance->_spritesheets.end()){
+    Spritesheet spritesheet {pxr::gfx::loadSpritesheet(name.c_str()), 0, nullptr};
+    search = instance->_spritesheets.emplace(name, std::move(spritesheet)).first;
+  }
+  ++search->second._refs;
+  return search->second._key;
+}
+
+void ResourceCache::releaseSpritesheet(const std::string& name)
+{
+  assert(instance != nullptr);
+  auto search = instance->_spritesheets.find(name);
+  if(search == instance->_spritesheets.end()){
+    pxr::log::log(pxr::log::WARN, msg_release_unknown, name);
+    return;
+  }
+  if(--search->second._refs == 0){
+    pxr::gfx::unloadSpritesheet(search->second._key);
+    instance->_spritesheets.erase(search);
+  }
+}
+
+pxr::sfx::ResourceKey_t ResourceCache::acquireSound(const std::string& name)
+{
+  assert(instance != nullptr);
+  auto search = instance->_sounds.find(name);
+  if(search == instance->_sounds.end())
+    search = instance->_sounds.emplace(name, Sound{pxr::sfx::loadSound(name.c_str()), 0}).first;
+  ++search->second._refs;
+  return search->second._key;
+}
+
+void ResourceCache::releaseSound(const std::string& name)
+{
+  assert(instance != nullptr);
+  auto search = instance->_sounds.find(name);
+  if(search == instance->_sounds.end()){
+    pxr::log::log(pxr::log::WARN, msg_release_unknown, name);
+    return;
+  }
+  if(--search->second._refs == 0){
+    pxr::sfx::unloadSound(search->second._key);
+    instance->_sounds.erase(search);
+  }
+}
+
+void ResourceCache::attachSpritesheetData(const std::string& name, std::shared_ptr<const SpritesheetData> data)
+{
+  assert(instance != nullptr);
+  auto search = instance->_spritesheets.find(name);
+  assert(search != instance->_spritesheets.end());
+  search->second._data = std::move(data);
+}
+
+std::shared_ptr<const SpritesheetData> ResourceCache::getSpritesheetData(const std::string& name)
+{
+  assert(instance != nullptr);
+  auto search = instance->_spritesheets.find(name);
+  return search == instance->_spritesheets.end() ? nullptr : search->second._data;
+}
+
+void ResourceCache::logReport()
+{
+  if(instance == nullptr)
+    return;
+
+  pxr::log::log(pxr::log::INFO, msg_report_start);
+
+  int64_t total {0};
+  char buffer[128];
+
+  for(const auto& pair : instance->_spritesheets){
+    const Spritesheet& spritesheet = pair.second;
+    int64_t bytes {0};
+    if(spritesheet._data != nullptr)
+      bytes = static_cast<int64_t>(spritesheet._data->_pixels.size() * sizeof(uint32_t));
+    else {
+      std::string path {};
+      path += SpritesheetData::RESOURCE_PATH_SPRITESHEETS;
+      path += pair.first;
+      path += SpritesheetData::BITMAP_FILE_EXTENSION;
+      bytes = getFileSize(path);
+    }
+    total += bytes;
+    std::snprintf(buffer, sizeof(buffer), "%s: %d refs, %lld bytes", pair.first.c_str(),
+                  spritesheet._refs, static_cast<long long>(bytes));
+    pxr::log::log(pxr::log::INFO, msg_report_spritesheet, buffer);
+  }
+
+  for(const auto& pair : instance->_sounds){
+    std::string path {};
+    path += RESOURCE_PATH_SOUNDS;
+    path += pair.first;
+    path += SOUND_FILE_EXTENSION;
+    int64_t bytes = getFileSize(path);
+    total += bytes;
+    std::snprintf(buffer, sizeof(buffer), "%s: %d refs, %lld bytes", pair.first.c_str(),
+                  pair.second._refs, static_cast<long long>(bytes));
+    pxr::log::log(pxr::log::INFO, msg_report_sound, buffer);
+  }
+
+  pxr::log::log(pxr::log::INFO, msg_report_total, std::to_string(total));
+}
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cassert>
+#include "SpriteMask.h"
+
+SpriteMask::SpriteMask(pxr::iRect rect, pxr::Vector2i origin, const std::function<bool(int, int)>& isOpaque) :
+  _size{rect._w, rect._h},
+  _origin{origin},
+  _wordsPerRow{0},
+  _rows{},
+  _rowsMirrorX{},
+  _opaqueBounds{},
+  _tileCount{0, 0},
+  _tiles{}
+{
+  assert(rect._w >= 0 && rect._h >= 0);
+
+  _wordsPerRow = std::max(1, (rect._w + bitsPerWord - 1) / bitsPerWord);
+  _rows.resize(_wordsPerRow * rect._h, 0);
+  _rowsMirrorX.resize(_wordsPerRow * rect._h, 0);
+
+  for(int row = 0; row < rect._h; ++row){
+    uint64_t* words = _rows.data() + (row * _wordsPerRow);
+    uint64_t* mirrorWords = _rowsMirrorX.data() + (row * _wordsPerRow);
+    for(int col = 0; col < rect._w; ++col){
+      if(!isOpaque(rect._x + col, rect._y + row))
+        continue;
+      int mirrorCol = rect._w - 1 - col;
+      words[col / bitsPerWord] |= uint64_t{1} << (col % bitsPerWord);
+      mirrorWords[mirrorCol / bitsPerWord] |= uint64_t{1} << (mirrorCol % bitsPerWord);
+    }
+  }
+
+  _tileCount._x = (rect._w + tileSize - 1) / tileSize;
+  _tileCount._y = (rect._h + tileSize - 1) / tileSize;
+
+  for(int mirror = 0; mirror < 4; ++mirror){
+    bool mirrorX = mirror & 1;
+    bool mirrorY = mirror & 2;
+
+    int colMin {rect._w}, colMax {-1}, rowMin {rect._h}, rowMax {-1};
+    auto& tiles = _tiles[mirror];
+    tiles.assign(_tileCount._x * _tileCount._y, false);
+
+    for(int row = 0; row < rect._h; ++row){
+      const uint64_t* words = getRow(mirrorY ? rect._h - 1 - row : row, mirrorX);
+      for(int col = 0; col < rect._w; ++col){
+        if(((words[col / bitsPerWord] >> (col % bitsPerWord)) & 1) == 0)
+          continue;
+        colMin = std::min(colMin, col);
+        colMax = std::max(colMax, col);
+        rowMin = std::min(rowMin, row);
+        rowMax = std::max(rowMax, row);
+        tiles[((row / tileSize) * _tileCount._x) + (col / tileSize)] = true;
+      }
+    }
+
+    auto& bounds = _opaqueBounds[mirror];
+    if(colMax < 0)
+      bounds = pxr::iRect{0, 0, 0, 0};
+    else {
+      bounds._x = colMin;
+      bounds._y = rowMin;
+      bounds._w = colMax - colMin + 1;
+      bounds._h = rowMax - rowMin + 1;
+    }
+  }
+}
+
+const uint64_t* SpriteMask::getRow(int row, bool mirrorX) const
+{
+  assert(0 <= row && row < _size._y);
+  return (mirrorX ? _rowsMirrorX.data() : _rows.data()) + (row * _wordsPerRow);
+}
+
+const pxr::iRect& SpriteMask::getOpaqueBounds(bool mirrorX, bool mirrorY) const
+{
+  return _opaqueBounds[toMirrorIndex(mirrorX, mirrorY)];
+}
+
+bool SpriteMask::isTileOccupied(int col, int row, bool mirrorX, bool mirrorY) const
+{
+  assert(0 <= col && col < _tileCount._x);
+  assert(0 <= row && row < _tileCount._y);
+  return _tiles[toMirrorIndex(mirrorX, mirrorY)][(row * _tileCount._x) + col];
+}
+
+//
+// Returns the bottom-left corner of the subject's sprite w.r.t world space.
+//
+static pxr::Vector2i getCorner(const MaskSubject& subject)
+{
+  return subject._position - subject._mask->getOrigin();
+}
+
+bool isOpaqueBoundsIntersection(const MaskSubject& a, const MaskSubject& b)
+{
+  assert(a._mask != nullptr && b._mask != nullptr);
+
+  const pxr::iRect& boundsA = a._mask->getOpaqueBounds(a._mirrorX, a._mirrorY);
+  const pxr::iRect& boundsB = b._mask->getOpaqueBounds(b._mirrorX, b._mirrorY);
+
+  if(boundsA._w == 0 || boundsB._w == 0)
+    return false;
+
+  pxr::Vector2i cornerA = getCorner(a);
+  pxr::Vector2i cornerB = getCorner(b);
+
+  int axmin = cornerA._x + boundsA._x;
+  int aymin = cornerA._y + boundsA._y;
+  int bxmin = cornerB._x + boundsB._x;
+  int bymin = cornerB._y + boundsB._y;
+
+  return axmin < bxmin + boundsB._w && bxmin < axmin + boundsA._w &&
+         aymin < bymin + boundsB._h && bymin < aymin + boundsA._h;
+}
+
+bool isTileIntersection(const MaskSubject& a, const MaskSubject& b)
+{
+  assert(a._mask != nullptr && b._mask != nullptr);
+
+  const SpriteMask& maskA = *a._mask;
+  const SpriteMask& maskB = *b._mask;
+
+  pxr::Vector2i cornerA = getCorner(a);
+  pxr::Vector2i cornerB = getCorner(b);
+
+  //
+  // floor division (positions may be negative) of an offset into a tile index.
+  //
+  auto toTile = [](int offset){
+    return offset >= 0 ? offset / SpriteMask::tileSize : -((-offset + SpriteMask::tileSize - 1) / SpriteMask::tileSize);
+  };
+
+  pxr::Vector2i tileCountA = maskA.getTileCount();
+  pxr::Vector2i tileCountB = maskB.getTileCount();
+
+  //
+  // Each occupied tile of A overlaps at most 2x2 tiles of B since the tiles are equal size.
+  //
+  for(int rowA = 0; rowA < tileCountA._y; ++rowA){
+    int yA = cornerA._y + (rowA * SpriteMask::tileSize);
+    int rowBMin = std::max(0, toTile(yA - cornerB._y));
+    int rowBMax = std::min(tileCountB._y - 1, toTile(yA + SpriteMask::tileSize - 1 - cornerB._y));
+    if(rowBMin > rowBMax)
+      continue;
+
+    for(int colA = 0; colA < tileCountA._x; ++colA){
+      if(!maskA.isTileOccupied(colA, rowA, a._mirrorX, a._mirrorY))
+        continue;
+
+      int xA = cornerA._x + (colA * SpriteMask::tileSize);
+      int colBMin = std::max(0, toTile(xA - cornerB._x));
+      int colBMax = std::min(tileCountB._x - 1, toTile(xA + SpriteMask::tileSize - 1 - cornerB._x));
+
+      for(int rowB = rowBMin; rowB <= rowBMax; ++rowB)
+        for(int colB = colBMin; colB <= colBMax; ++colB)
+          if(maskB.isTileOccupied(colB, rowB, b._mirrorX, b._mirrorY))
+            return true;
+    }
+  }
+
+  return false;
+}
+
+//
+// Returns the 64 bits of a row starting at bit 'offset'; bits beyond the row are zero.
+//
+static uint64_t extractBits(const uint64_t* words, int wordCount, int offset)
+{
+  int word = offset / SpriteMask::bitsPerWord;
+  int shift = offset % SpriteMask::bitsPerWord;
+  uint64_t bits = words[word] >> shift;
+  if(shift != 0 && word + 1 < wordCount)
+    bits |= words[word + 1] << (SpriteMask::bitsPerWord - shift);
+  return bits;
+}
+
+bool isMaskIntersection(const MaskSubject& a, const MaskSubject& b)
+{
+  assert(a._mask != nullptr && b._mask != nullptr);
+
+  const SpriteMask& maskA = *a._mask;
+  const SpriteMask& maskB = *b._mask;
+
+  pxr::Vector2i cornerA = getCorner(a);
+  pxr::Vector2i cornerB = getCorner(b);
+
+  //
+  // only the overlap of the opaque bounds can contain overlapping opaque pixels.
+  //
+  const pxr::iRect& boundsA = maskA.getOpaqueBounds(a._mirrorX, a._mirrorY);
+  const pxr::iRect& boundsB = maskB.getOpaqueBounds(b._mirrorX, b._mirrorY);
+
+  int xmin = std::max(cornerA._x + boundsA._x, cornerB._x + boundsB._x);
+  int xmax = std::min(cornerA._x + boundsA._x + boundsA._w, cornerB._x + boundsB._x + boundsB._w);
+  int ymin = std::max(cornerA._y + boundsA._y, cornerB._y + boundsB._y);
+  int ymax = std::min(cornerA._y + boundsA._y + boundsA._h, cornerB._y + boundsB._y + boundsB._h);
+
+  if(xmin >= xmax || ymin >= ymax)
+    return false;
+
+  for(int y = ymin; y < ymax; ++y){
+    int rowA = y - cornerA._y;
+    int rowB = y - cornerB._y;
+    if(a._mirrorY) rowA = maskA.getSize()._y - 1 - rowA;
+    if(b._mirrorY) rowB = maskB.getSize()._y - 1 - rowB;
+
+    const uint64_t* wordsA = maskA.getRow(rowA, a._mirrorX);
+    const uint64_t* wordsB = maskB.getRow(rowB, b._mirrorX);
+
+    for(int x = xmin; x < xmax; x += SpriteMask::bitsPerWord){
+      int width = std::min(SpriteMask::bitsPerWord, xmax - x);
+      uint64_t widthMask = width == SpriteMask::bitsPerWord ? ~uint64_t{0} :
+                                                              (uint64_t{1} << width) - 1;
+      uint64_t bitsA = extractBits(wordsA, maskA.getWordsPerRow(), x - cornerA._x);
+      uint64_t bitsB = extractBits(wordsB, maskB.getWordsPerRow(), x - cornerB._x);
+      if(bitsA & bitsB & widthMask)
+        return true;
+    }
+  }
+
+  return false;
+}
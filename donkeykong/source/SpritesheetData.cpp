@@ -0,0 +1,230 @@
+#include <fstream>
+#include <iterator>
+#include <cassert>
+#include "pixiretro/pxr_xml.h"
+#include "pixiretro/pxr_log.h"
+#include "SpritesheetData.h"
+
+using namespace tinyxml2;
+
+//
+// log strings.
+//
+static constexpr const char* msg_load_start = "loading spritesheet data";
+static constexpr const char* msg_load_abort = "aborting spritesheet data load due to error";
+static constexpr const char* msg_open_fail = "failed to open file";
+static constexpr const char* msg_not_bitmap = "file is not a bitmap";
+static constexpr const char* msg_unsupported_bitmap = "unsupported bitmap format (need 24/32 bit uncompressed)";
+static constexpr const char* msg_truncated_bitmap = "bitmap file truncated";
+static constexpr const char* msg_sprite_out_of_bounds = "sprite rect exceeds spritesheet image bounds";
+
+static constexpr uint32_t BI_RGB {0};
+static constexpr uint32_t BI_BITFIELDS {3};
+
+static uint16_t readU16(const std::vector<uint8_t>& bytes, size_t offset)
+{
+  return static_cast<uint16_t>(bytes[offset] | (bytes[offset + 1] << 8));
+}
+
+static uint32_t readU32(const std::vector<uint8_t>& bytes, size_t offset)
+{
+  return static_cast<uint32_t>(bytes[offset]) |
+         (static_cast<uint32_t>(bytes[offset + 1]) << 8) |
+         (static_cast<uint32_t>(bytes[offset + 2]) << 16) |
+         (static_cast<uint32_t>(bytes[offset + 3]) << 24);
+}
+
+//
+// Extracts a channel from a pixel given the channel mask and scales it to 8 bits.
+//
+static uint32_t extractChannel(uint32_t pixel, uint32_t mask)
+{
+  if(mask == 0)
+    return 0;
+  int shift {0};
+  while(((mask >> shift) & 1) == 0)
+    ++shift;
+  uint32_t max = mask >> shift;
+  uint32_t value = (pixel & mask) >> shift;
+  return (value * 255) / max;
+}
+
+static bool decodeBitmap(const std::string& bmppath, SpritesheetData* data, const char** error)
+{
+  std::ifstream file {bmppath, std::ios::binary};
+  if(!file){
+    *error = msg_open_fail;
+    return false;
+  }
+
+  std::vector<uint8_t> bytes {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+  if(bytes.size() < 54 || bytes[0] != 'B' || bytes[1] != 'M'){
+    *error = msg_not_bitmap;
+    return false;
+  }
+
+  uint32_t pixelOffset = readU32(bytes, 10);
+  uint32_t headerSize = readU32(bytes, 14);
+  int32_t width = static_cast<int32_t>(readU32(bytes, 18));
+  int32_t height = static_cast<int32_t>(readU32(bytes, 22));
+  uint16_t bitsPerPixel = readU16(bytes, 28);
+  uint32_t compression = readU32(bytes, 30);
+
+  if((bitsPerPixel != 24 && bitsPerPixel != 32) ||
+     (compression != BI_RGB && compression != BI_BITFIELDS) || width <= 0 || height == 0)
+  {
+    *error = msg_unsupported_bitmap;
+    return false;
+  }
+
+  uint32_t redMask {0x00ff0000}, greenMask {0x0000ff00}, blueMask {0x000000ff};
+  uint32_t alphaMask = bitsPerPixel == 32 ? 0xff000000 : 0;
+  if(compression == BI_BITFIELDS && bytes.size() >= 66){
+    redMask = readU32(bytes, 54);
+    greenMask = readU32(bytes, 58);
+    blueMask = readU32(bytes, 62);
+    if(headerSize >= 56 && bytes.size() >= 70)
+      alphaMask = readU32(bytes, 66);
+  }
+
+  //
+  // a negative height denotes a top-down bitmap; we store bottom-up.
+  //
+  bool isTopDown = height < 0;
+  if(isTopDown)
+    height = -height;
+
+  size_t bytesPerPixel = bitsPerPixel / 8;
+  size_t rowStride = ((bitsPerPixel * static_cast<size_t>(width) + 31) / 32) * 4;
+  if(bytes.size() < pixelOffset + (rowStride * height)){
+    *error = msg_truncated_bitmap;
+    return false;
+  }
+
+  data->_width = width;
+  data->_height = height;
+  data->_pixels.resize(static_cast<size_t>(width) * height);
+
+  for(int row = 0; row < height; ++row){
+    int fileRow = isTopDown ? (height - 1 - row) : row;
+    size_t rowOffset = pixelOffset + (rowStride * fileRow);
+    for(int col = 0; col < width; ++col){
+      size_t offset = rowOffset + (bytesPerPixel * col);
+      uint32_t pixel = bitsPerPixel == 32 ? readU32(bytes, offset) :
+                       (bytes[offset] | (bytes[offset + 1] << 8) | (bytes[offset + 2] << 16));
+      uint32_t r = extractChannel(pixel, redMask);
+      uint32_t g = extractChannel(pixel, greenMask);
+      uint32_t b = extractChannel(pixel, blueMask);
+      uint32_t a = alphaMask != 0 ? extractChannel(pixel, alphaMask) : 255;
+      data->_pixels[(row * width) + col] = r | (g << 8) | (b << 16) | (a << 24);
+    }
+  }
+
+  return true;
+}
+
+static bool loadSprites(const std::string& xmlpath, SpritesheetData* data)
+{
+  XMLDocument doc {};
+  if(!pxr::io::parseXmlDocument(&doc, xmlpath))
+    return false;
+
+  XMLElement* xmlspritesheet {nullptr};
+  XMLElement* xmlsprite {nullptr};
+
+  if(!pxr::io::extractChildElement(&doc, &xmlspritesheet, "spritesheet")) return false;
+  if(!pxr::io::extractChildElement(xmlspritesheet, &xmlsprite, "sprite")) return false;
+
+  do {
+    SpritesheetData::Sprite sprite {};
+    if(!pxr::io::extractIntAttribute(xmlsprite, "x", &sprite._x)) return false;
+    if(!pxr::io::extractIntAttribute(xmlsprite, "y", &sprite._y)) return false;
+    if(!pxr::io::extractIntAttribute(xmlsprite, "w", &sprite._w)) return false;
+    if(!pxr::io::extractIntAttribute(xmlsprite, "h", &sprite._h)) return false;
+    if(!pxr::io::extractIntAttribute(xmlsprite, "ox", &sprite._ox)) return false;
+    if(!pxr::io::extractIntAttribute(xmlsprite, "oy", &sprite._oy)) return false;
+
+    if(sprite._x < 0 || sprite._y < 0 || sprite._w < 0 || sprite._h < 0 ||
+       sprite._x + sprite._w > data->_width || sprite._y + sprite._h > data->_height)
+    {
+      pxr::log::log(pxr::log::ERROR, msg_sprite_out_of_bounds, xmlpath);
+      return false;
+    }
+
+    data->_sprites.push_back(sprite);
+
+    xmlsprite = xmlsprite->NextSiblingElement("sprite");
+  }
+  while(xmlsprite != 0);
+
+  return true;
+}
+
+bool loadSpritesheetBitmap(const std::string& name, SpritesheetData* data, const char** error)
+{
+  assert(data != nullptr);
+  assert(error != nullptr);
+
+  std::string path {};
+  path += SpritesheetData::RESOURCE_PATH_SPRITESHEETS;
+  path += name;
+  path += SpritesheetData::BITMAP_FILE_EXTENSION;
+
+  data->_name = name;
+  data->_width = 0;
+  data->_height = 0;
+  data->_pixels.clear();
+  *error = nullptr;
+
+  return decodeBitmap(path, data, error);
+}
+
+bool loadSpritesheetSprites(const std::string& name, SpritesheetData* data)
+{
+  assert(data != nullptr);
+
+  std::string path {};
+  path += SpritesheetData::RESOURCE_PATH_SPRITESHEETS;
+  path += name;
+
+  data->_sprites.clear();
+
+  if(!loadSprites(path + SpritesheetData::SPRITESHEET_FILE_EXTENSION, data)){
+    pxr::log::log(pxr::log::ERROR, msg_load_abort, path);
+    return false;
+  }
+
+  return true;
+}
+
+bool loadSpritesheetData(const std::string& name, SpritesheetData* data)
+{
+  assert(data != nullptr);
+
+  std::string path {};
+  path += SpritesheetData::RESOURCE_PATH_SPRITESHEETS;
+  path += name;
+
+  pxr::log::log(pxr::log::INFO, msg_load_start, path);
+
+  data->_name = name;
+  data->_width = 0;
+  data->_height = 0;
+  data->_pixels.clear();
+  data->_sprites.clear();
+
+  const char* error {nullptr};
+  if(!decodeBitmap(path + SpritesheetData::BITMAP_FILE_EXTENSION, data, &error)){
+    pxr::log::log(pxr::log::ERROR, error, path);
+    pxr::log::log(pxr::log::ERROR, msg_load_abort, path);
+    return false;
+  }
+
+  if(!loadSprites(path + SpritesheetData::SPRITESHEET_FILE_EXTENSION, data)){
+    pxr::log::log(pxr::log::ERROR, msg_load_abort, path);
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,204 @@
+#include "Trace.h"
+
+#ifdef DK_TRACING
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "pixiretro/pxr_log.h"
+
+//
+// log strings.
+//
+static constexpr const char* msg_trace_start = "tracing to file";
+static constexpr const char* msg_open_fail = "failed to open trace file";
+
+//
+// Details are copied into the event, truncated to fit, since the writer formats them after
+// the caller may have freed them.
+//
+static constexpr size_t detailSize {48};
+
+struct TraceEvent
+{
+  const char* _name;
+  char _detail[detailSize];
+  int _value;
+  char _phase;
+  uint32_t _threadid;
+  Trace::Clock_t::time_point _start;
+  Trace::Clock_t::time_point _end;
+};
+
+//
+// The writer thread wakes when this many events are queued, or periodically otherwise.
+//
+static constexpr size_t writeBatchSize {4096};
+static constexpr std::chrono::milliseconds writeInterval {50};
+
+//
+// The file is only touched by the thread which initializes and shuts down tracing, and by
+// the writer. Event producers (which include the loader threads) check isRecording instead.
+//
+static std::FILE* file {nullptr};
+static std::atomic<bool> isRecording {false};
+static Trace::Clock_t::time_point epoch {};
+static bool isFirstEvent {true};
+
+static std::mutex queueMutex {};
+static std::condition_variable queueCondition {};
+static std::vector<TraceEvent> queue {};
+static bool isShuttingDown {false};
+static std::thread writer {};
+static bool isExitHandlerSet {false};
+
+static std::atomic<uint32_t> nextThreadid {0};
+
+static uint32_t getThreadid()
+{
+  static thread_local uint32_t threadid {nextThreadid.fetch_add(1)};
+  return threadid;
+}
+
+static double toMicroseconds(Trace::Clock_t::duration duration)
+{
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+static void writeEvent(const TraceEvent& event)
+{
+  std::fputs(isFirstEvent ? "\n" : ",\n", file);
+  isFirstEvent = false;
+
+  double ts = toMicroseconds(event._start - epoch);
+  if(event._phase == 'X'){
+    std::fprintf(file, "{\"name\":\"%s\",\"cat\":\"dk\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+                       "\"ts\":%.3f,\"dur\":%.3f}",
+                 event._name, event._threadid, ts, toMicroseconds(event._end - event._start));
+  }
+  else {
+    std::fprintf(file, "{\"name\":\"%s\",\"cat\":\"dk\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,"
+                       "\"tid\":%u,\"ts\":%.3f,\"args\":{\"detail\":\"%s\",\"value\":%d}}",
+                 event._name, event._threadid, ts, event._detail, event._value);
+  }
+}
+
+static void runWriter()
+{
+  std::vector<TraceEvent> batch {};
+  bool isDone {false};
+  while(!isDone){
+    {
+      std::unique_lock<std::mutex> lock {queueMutex};
+      queueCondition.wait_for(lock, writeInterval, [](){
+        return isShuttingDown || queue.size() >= writeBatchSize;
+      });
+      batch.swap(queue);
+      isDone = isShuttingDown;
+    }
+    for(const auto& event : batch)
+      writeEvent(event);
+    batch.clear();
+    std::fflush(file);
+  }
+}
+
+bool Trace::initialize()
+{
+  if(file != nullptr)
+    return true;
+
+  pxr::log::log(pxr::log::INFO, msg_trace_start, TRACE_FILE_PATH);
+
+  file = std::fopen(TRACE_FILE_PATH, "w");
+  if(file == nullptr){
+    pxr::log::log(pxr::log::ERROR, msg_open_fail, TRACE_FILE_PATH);
+    return false;
+  }
+
+  //
+  // the closing bracket is optional in the trace event format, so a trace cut short by a
+  // crash is still readable.
+  //
+  std::fputs("[", file);
+  epoch = Clock_t::now();
+  isFirstEvent = true;
+  isShuttingDown = false;
+  writer = std::thread{runWriter};
+  isRecording.store(true);
+
+  //
+  // the writer must be joined before the static thread object is destroyed, and the queued
+  // events written, even if the game leaves through std::exit without shutting down.
+  //
+  if(!isExitHandlerSet){
+    std::atexit(Trace::shutdown);
+    isExitHandlerSet = true;
+  }
+
+  return true;
+}
+
+void Trace::shutdown()
+{
+  if(file == nullptr)
+    return;
+
+  isRecording.store(false);
+  {
+    std::lock_guard<std::mutex> lock {queueMutex};
+    isShuttingDown = true;
+  }
+  queueCondition.notify_one();
+  writer.join();
+
+  std::fputs("\n]\n", file);
+  std::fclose(file);
+  file = nullptr;
+}
+
+void Trace::pushEvent(char phase, const char* name, const char* detail, int value,
+                      Clock_t::time_point start, Clock_t::time_point end)
+{
+  if(!isRecording.load(std::memory_order_relaxed))
+    return;
+
+  TraceEvent event {name, {}, value, phase, getThreadid(), start, end};
+  if(detail != nullptr){
+    std::strncpy(event._detail, detail, detailSize - 1);
+    event._detail[detailSize - 1] = '\0';
+  }
+
+  bool isBatchReady {false};
+  {
+    std::lock_guard<std::mutex> lock {queueMutex};
+    if(isShuttingDown)
+      return;
+    queue.push_back(event);
+    isBatchReady = queue.size() == writeBatchSize;
+  }
+  if(isBatchReady)
+    queueCondition.notify_one();
+}
+
+#else
+
+bool Trace::initialize()
+{
+  return true;
+}
+
+void Trace::shutdown()
+{
+}
+
+void Trace::pushEvent(char, const char*, const char*, int, Clock_t::time_point, Clock_t::time_point)
+{
+}
+
+#endif
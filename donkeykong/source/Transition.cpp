@@ -135,3 +135,33 @@ float Transition::getSpeed() const
   return _speed;
 }
 
+
+Transition::Snapshot Transition::getSnapshot() const
+{
+  return Snapshot{
+    _position,
+    _direction,
+    _speed,
+    _lerpClock,
+    _fromPosition,
+    _toPosition,
+    _fromSpeed,
+    _toSpeed,
+    _isMoving,
+    _isAccelerating
+  };
+}
+
+void Transition::restore(const Snapshot& snapshot)
+{
+  _position = snapshot._position;
+  _direction = snapshot._direction;
+  _speed = snapshot._speed;
+  _lerpClock = snapshot._lerpClock;
+  _fromPosition = snapshot._fromPosition;
+  _toPosition = snapshot._toPosition;
+  _fromSpeed = snapshot._fromSpeed;
+  _toSpeed = snapshot._toSpeed;
+  _isMoving = snapshot._isMoving;
+  _isAccelerating = snapshot._isAccelerating;
+}
@@ -0,0 +1,407 @@
+//
+// Compiles the prop definitions file (gameprops.xml) and level files into the binary asset
+// pack loaded by AssetPack (see AssetPack.h for the format). Prop names used by levels are
+// resolved to definition indices here, so an unknown prop name fails the compile rather
+// than the game. The size and modification time of each file compiled are recorded so the
+// game can tell when the pack is stale.
+//
+// usage: dk_packc [level ...]
+//
+// Packs every level listed in dkconfig.xml plus any named on the command line. Writes
+// assets/assets.dkpack. Must be run from the game root dir (as the game is).
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "pixiretro/pxr_xml.h"
+#include "AssetPack.h"
+#include "PropFactory.h"
+#include "Level.h"
+
+using namespace tinyxml2;
+
+static constexpr const char* dkconfigPath {"assets/dkconfig.xml"};
+
+//
+// The pack under construction; one vector per section.
+//
+struct Pack
+{
+  std::vector<char> _chars;
+  std::vector<pack::String> _strings;
+  std::vector<pack::Point> _points;
+  std::vector<pack::SpeedPoint> _speedPoints;
+  std::vector<uint32_t> _soundNames;
+  std::vector<pack::State> _states;
+  std::vector<pack::PropDefinition> _propDefinitions;
+  std::vector<pack::LevelProp> _levelProps;
+  std::vector<pack::Level> _levels;
+  std::vector<pack::Source> _sources;
+
+  std::unordered_map<std::string, uint32_t> _stringIndices;
+  std::unordered_map<std::string, uint32_t> _propIndices;
+
+  uint32_t addString(const std::string& s)
+  {
+    auto search = _stringIndices.find(s);
+    if(search != _stringIndices.end())
+      return search->second;
+    pack::String string {static_cast<uint32_t>(_chars.size()), static_cast<uint32_t>(s.size())};
+    _chars.insert(_chars.end(), s.begin(), s.end());
+    _chars.push_back('\0');
+    uint32_t index = _strings.size();
+    _strings.push_back(string);
+    _stringIndices.emplace(s, index);
+    return index;
+  }
+
+  bool addSource(const std::string& path)
+  {
+    pack::Source source {};
+    source._path = addString(path);
+    uint64_t mtime {0};
+    if(!AssetPack::statFile(path, &source._size, &mtime))
+      return false;
+    source._mtimeLow = static_cast<uint32_t>(mtime);
+    source._mtimeHigh = static_cast<uint32_t>(mtime >> 32);
+    _sources.push_back(source);
+    return true;
+  }
+};
+
+static bool fail(const char* what, const std::string& where)
+{
+  std::fprintf(stderr, "%s: %s\n", where.c_str(), what);
+  return false;
+}
+
+static bool compileStates(XMLElement* xmlprop, Pack& out, const std::string& propName)
+{
+  XMLElement* xmlstate {nullptr};
+  XMLElement* xmltransition {nullptr};
+  XMLElement* xmlpoints {nullptr};
+  XMLElement* xmlpoint {nullptr};
+  XMLElement* xmlbox {nullptr};
+  XMLElement* xmleffects {nullptr};
+  XMLElement* xmleffect {nullptr};
+  XMLElement* xmlsounds {nullptr};
+  XMLElement* xmlsound {nullptr};
+  XMLElement* xmlanimation {nullptr};
+
+  if(!pxr::io::extractChildElement(xmlprop, &xmlstate, "state")) return fail("no states", propName);
+
+  do {
+    pack::State state {};
+    if(!pxr::io::extractFloatAttribute(xmlstate, "duration", &state._duration)) return fail("bad state", propName);
+
+    if(!pxr::io::extractChildElement(xmlstate, &xmltransition, "transition")) return fail("no transition", propName);
+
+    state._positions._first = out._points.size();
+    if(!pxr::io::extractChildElement(xmltransition, &xmlpoints, "positions")) return fail("no positions", propName);
+    if(!pxr::io::extractChildElement(xmlpoints, &xmlpoint, "point")) return fail("no position points", propName);
+    do {
+      pack::Point point {};
+      if(!pxr::io::extractFloatAttribute(xmlpoint, "x", &point._x)) return fail("bad position", propName);
+      if(!pxr::io::extractFloatAttribute(xmlpoint, "y", &point._y)) return fail("bad position", propName);
+      out._points.push_back(point);
+      xmlpoint = xmlpoint->NextSiblingElement("point");
+    }
+    while(xmlpoint != 0);
+    state._positions._count = out._points.size() - state._positions._first;
+
+    state._speeds._first = out._speedPoints.size();
+    if(!pxr::io::extractChildElement(xmltransition, &xmlpoints, "speeds")) return fail("no speeds", propName);
+    if(!pxr::io::extractChildElement(xmlpoints, &xmlpoint, "point")) return fail("no speed points", propName);
+    do {
+      pack::SpeedPoint point {};
+      if(!pxr::io::extractFloatAttribute(xmlpoint, "value", &point._value)) return fail("bad speed", propName);
+      if(!pxr::io::extractFloatAttribute(xmlpoint, "duration", &point._duration)) return fail("bad speed", propName);
+      out._speedPoints.push_back(point);
+      xmlpoint = xmlpoint->NextSiblingElement("point");
+    }
+    while(xmlpoint != 0);
+    state._speeds._count = out._speedPoints.size() - state._speeds._first;
+
+    if(!pxr::io::extractChildElement(xmlstate, &xmlbox, "interactionBox")) return fail("no interaction box", propName);
+    if(!pxr::io::extractFloatAttribute(xmlbox, "x", &state._boxX)) return fail("bad box", propName);
+    if(!pxr::io::extractFloatAttribute(xmlbox, "y", &state._boxY)) return fail("bad box", propName);
+    if(!pxr::io::extractFloatAttribute(xmlbox, "width", &state._boxW)) return fail("bad box", propName);
+    if(!pxr::io::extractFloatAttribute(xmlbox, "height", &state._boxH)) return fail("bad box", propName);
+
+    if(!pxr::io::extractChildElement(xmlstate, &xmleffects, "effects")) return fail("no effects", propName);
+
+    int isActive {0};
+    if(!pxr::io::extractChildElement(xmleffects, &xmleffect, "support")) return fail("no support", propName);
+    if(!pxr::io::extractIntAttribute(xmleffect, "active", &isActive)) return fail("bad support", propName);
+    if(!pxr::io::extractFloatAttribute(xmleffect, "height", &state._supportHeight)) return fail("bad support", propName);
+    if(isActive) state._flags |= pack::FLAG_SUPPORT;
+
+    if(!pxr::io::extractChildElement(xmleffects, &xmleffect, "ladder")) return fail("no ladder", propName);
+    if(!pxr::io::extractIntAttribute(xmleffect, "active", &isActive)) return fail("bad ladder", propName);
+    if(!pxr::io::extractFloatAttribute(xmleffect, "height", &state._ladderHeight)) return fail("bad ladder", propName);
+    if(isActive) state._flags |= pack::FLAG_LADDER;
+
+    if(!pxr::io::extractChildElement(xmleffects, &xmleffect, "conveyor")) return fail("no conveyor", propName);
+    if(!pxr::io::extractIntAttribute(xmleffect, "active", &isActive)) return fail("bad conveyor", propName);
+    if(!pxr::io::extractFloatAttribute(xmleffect, "velocityX", &state._conveyorVelocityX)) return fail("bad conveyor", propName);
+    if(!pxr::io::extractFloatAttribute(xmleffect, "velocityY", &state._conveyorVelocityY)) return fail("bad conveyor", propName);
+    if(isActive) state._flags |= pack::FLAG_CONVEYOR;
+
+    int damage {0};
+    if(!pxr::io::extractChildElement(xmleffects, &xmleffect, "killer")) return fail("no killer", propName);
+    if(!pxr::io::extractIntAttribute(xmleffect, "active", &isActive)) return fail("bad killer", propName);
+    if(!pxr::io::extractIntAttribute(xmleffect, "damage", &damage)) return fail("bad killer", propName);
+    state._killerDamage = damage;
+    if(isActive) state._flags |= pack::FLAG_KILLER;
+
+    //
+    // as the xml loader, empty and "NA" sound names are skipped.
+    //
+    state._sounds._first = out._soundNames.size();
+    if(!pxr::io::extractChildElement(xmlstate, &xmlsounds, "sounds")) return fail("no sounds", propName);
+    if(!pxr::io::extractChildElement(xmlsounds, &xmlsound, "sound")) return fail("no sound", propName);
+    do {
+      const char* soundName {nullptr};
+      if(!pxr::io::extractStringAttribute(xmlsound, "name", &soundName)) return fail("bad sound", propName);
+      if(std::strlen(soundName) != 0 && std::strcmp(soundName, "NA") != 0)
+        out._soundNames.push_back(out.addString(soundName));
+      xmlsound = xmlsound->NextSiblingElement("sound");
+    }
+    while(xmlsound != 0);
+    state._sounds._count = out._soundNames.size() - state._sounds._first;
+
+    const char* animationName {nullptr};
+    if(!pxr::io::extractChildElement(xmlstate, &xmlanimation, "animation")) return fail("no animation", propName);
+    if(!pxr::io::extractStringAttribute(xmlanimation, "name", &animationName)) return fail("bad animation", propName);
+    state._animationName = out.addString(animationName);
+
+    out._states.push_back(state);
+
+    xmlstate = xmlstate->NextSiblingElement("state");
+  }
+  while(xmlstate != 0);
+
+  return true;
+}
+
+static bool compilePropDefinitions(Pack& out)
+{
+  std::string xmlpath {};
+  xmlpath += PropFactory::PROP_DEFINITIONS_FILE_PATH;
+  xmlpath += PropFactory::PROP_DEFINITIONS_FILE_NAME;
+  xmlpath += pxr::io::XML_FILE_EXTENSION;
+
+  XMLDocument doc {};
+  if(!pxr::io::parseXmlDocument(&doc, xmlpath))
+    return fail("failed to parse", xmlpath);
+
+  if(!out.addSource(xmlpath))
+    return fail("failed to stat", xmlpath);
+
+  XMLElement* xmlprop {nullptr};
+  if(!pxr::io::extractChildElement(&doc, &xmlprop, "prop"))
+    return fail("no props", xmlpath);
+
+  do {
+    const char* propName {nullptr};
+    if(!pxr::io::extractStringAttribute(xmlprop, "name", &propName) || std::strlen(propName) == 0)
+      return fail("bad prop name", xmlpath);
+
+    if(out._propIndices.count(propName) != 0)
+      return fail("duplicate prop definition", propName);
+
+    pack::PropDefinition def {};
+    def._name = out.addString(propName);
+
+    const char* modeName {nullptr};
+    if(!pxr::io::extractStringAttribute(xmlprop, "stateTransitionMode", &modeName)) return fail("bad prop", propName);
+    if(std::strcmp(modeName, "forward") == 0)
+      def._stateTransitionMode = pack::TRANSITION_FORWARD;
+    else if(std::strcmp(modeName, "random") == 0)
+      def._stateTransitionMode = pack::TRANSITION_RANDOM;
+    else
+      return fail("bad state transition mode", propName);
+
+    int drawLayer {0};
+    if(!pxr::io::extractIntAttribute(xmlprop, "drawLayer", &drawLayer)) return fail("bad prop", propName);
+    def._drawLayer = drawLayer;
+
+    def._states._first = out._states.size();
+    if(!compileStates(xmlprop, out, propName))
+      return false;
+    def._states._count = out._states.size() - def._states._first;
+
+    out._propIndices.emplace(propName, out._propDefinitions.size());
+    out._propDefinitions.push_back(def);
+
+    xmlprop = xmlprop->NextSiblingElement("prop");
+  }
+  while(xmlprop != 0);
+
+  return true;
+}
+
+static bool compileLevel(const std::string& levelName, Pack& out)
+{
+  std::string xmlpath {};
+  xmlpath += Level::RESOURCE_PATH_LEVEL;
+  xmlpath += levelName;
+  xmlpath += pxr::io::XML_FILE_EXTENSION;
+
+  XMLDocument doc {};
+  if(!pxr::io::parseXmlDocument(&doc, xmlpath))
+    return fail("failed to parse", xmlpath);
+
+  if(!out.addSource(xmlpath))
+    return fail("failed to stat", xmlpath);
+
+  XMLElement* xmllevel {nullptr};
+  XMLElement* xmlmariospawn {nullptr};
+  XMLElement* xmlprops {nullptr};
+  XMLElement* xmlprop {nullptr};
+
+  pack::Level level {};
+  level._name = out.addString(levelName);
+
+  if(!pxr::io::extractChildElement(&doc, &xmllevel, "level")) return fail("no level", xmlpath);
+  if(!pxr::io::extractChildElement(xmllevel, &xmlmariospawn, "marioSpawn")) return fail("no mario spawn", xmlpath);
+  if(!pxr::io::extractFloatAttribute(xmlmariospawn, "x", &level._marioSpawnX)) return fail("bad mario spawn", xmlpath);
+  if(!pxr::io::extractFloatAttribute(xmlmariospawn, "y", &level._marioSpawnY)) return fail("bad mario spawn", xmlpath);
+  if(!pxr::io::extractChildElement(xmllevel, &xmlprops, "props")) return fail("no props", xmlpath);
+  if(!pxr::io::extractChildElement(xmlprops, &xmlprop, "prop")) return fail("no props", xmlpath);
+
+  level._props._first = out._levelProps.size();
+  do {
+    const char* propName {nullptr};
+    pack::LevelProp prop {};
+    if(!pxr::io::extractStringAttribute(xmlprop, "name", &propName)) return fail("bad prop", xmlpath);
+    if(!pxr::io::extractFloatAttribute(xmlprop, "x", &prop._x)) return fail("bad prop", xmlpath);
+    if(!pxr::io::extractFloatAttribute(xmlprop, "y", &prop._y)) return fail("bad prop", xmlpath);
+
+    auto search = out._propIndices.find(propName);
+    if(search == out._propIndices.end())
+      return fail("unknown prop", std::string{xmlpath} + ": " + propName);
+    prop._definition = search->second;
+
+    out._levelProps.push_back(prop);
+    xmlprop = xmlprop->NextSiblingElement("prop");
+  }
+  while(xmlprop != 0);
+  level._props._count = out._levelProps.size() - level._props._first;
+
+  out._levels.push_back(level);
+  return true;
+}
+
+static bool readLevelNames(std::vector<std::string>& levelNames)
+{
+  XMLDocument doc {};
+  if(!pxr::io::parseXmlDocument(&doc, dkconfigPath))
+    return false;
+
+  XMLElement* xmldkconfig {nullptr};
+  XMLElement* xmllevels {nullptr};
+  XMLElement* xmllevel {nullptr};
+
+  if(!pxr::io::extractChildElement(&doc, &xmldkconfig, "dkconfig")) return false;
+  if(!pxr::io::extractChildElement(xmldkconfig, &xmllevels, "levels")) return false;
+  if(!pxr::io::extractChildElement(xmllevels, &xmllevel, "level")) return false;
+
+  do {
+    const char* levelName {nullptr};
+    if(!pxr::io::extractStringAttribute(xmllevel, "name", &levelName)) return false;
+    levelNames.push_back(levelName);
+    xmllevel = xmllevel->NextSiblingElement("level");
+  }
+  while(xmllevel != 0);
+
+  return true;
+}
+
+//
+// Appends a section's records to the file bytes (4 byte aligned) and records its range.
+//
+template<typename T>
+static void writeSection(std::vector<char>& bytes, pack::Header& header, pack::Section section,
+                         const std::vector<T>& records)
+{
+  while(bytes.size() % 4 != 0)
+    bytes.push_back('\0');
+  header._sections[section]._first = bytes.size();
+  header._sections[section]._count = records.size();
+  const char* first = reinterpret_cast<const char*>(records.data());
+  bytes.insert(bytes.end(), first, first + (records.size() * sizeof(T)));
+}
+
+static bool writePack(const Pack& in, const std::string& path)
+{
+  pack::Header header {};
+  std::memcpy(header._magic, pack::magic, sizeof(pack::magic));
+  header._version = pack::version;
+
+  std::vector<char> bytes(sizeof(pack::Header), '\0');
+  writeSection(bytes, header, pack::SECTION_CHARS, in._chars);
+  writeSection(bytes, header, pack::SECTION_STRINGS, in._strings);
+  writeSection(bytes, header, pack::SECTION_POINTS, in._points);
+  writeSection(bytes, header, pack::SECTION_SPEED_POINTS, in._speedPoints);
+  writeSection(bytes, header, pack::SECTION_SOUND_NAMES, in._soundNames);
+  writeSection(bytes, header, pack::SECTION_STATES, in._states);
+  writeSection(bytes, header, pack::SECTION_PROP_DEFINITIONS, in._propDefinitions);
+  writeSection(bytes, header, pack::SECTION_LEVEL_PROPS, in._levelProps);
+  writeSection(bytes, header, pack::SECTION_LEVELS, in._levels);
+  writeSection(bytes, header, pack::SECTION_SOURCES, in._sources);
+  std::memcpy(bytes.data(), &header, sizeof(header));
+
+  std::ofstream file {path, std::ios::binary | std::ios::trunc};
+  file.write(bytes.data(), bytes.size());
+  return static_cast<bool>(file);
+}
+
+int main(int argc, char** argv)
+{
+  uint32_t one {1};
+  if(*reinterpret_cast<const uint8_t*>(&one) != 1){
+    std::fprintf(stderr, "dk_packc must run on a little endian host\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> levelNames {};
+  if(!readLevelNames(levelNames)){
+    std::fprintf(stderr, "failed to read the levels from '%s'\n", dkconfigPath);
+    return EXIT_FAILURE;
+  }
+  for(int i = 1; i < argc; ++i)
+    levelNames.push_back(argv[i]);
+
+  Pack out {};
+  if(!compilePropDefinitions(out))
+    return EXIT_FAILURE;
+
+  std::unordered_map<std::string, bool> isPacked {};
+  for(const auto& levelName : levelNames){
+    if(isPacked[levelName])
+      continue;
+    if(!compileLevel(levelName, out))
+      return EXIT_FAILURE;
+    isPacked[levelName] = true;
+  }
+
+  std::string path {};
+  path += AssetPack::PACK_FILE_PATH;
+  path += AssetPack::PACK_FILE_NAME;
+  path += AssetPack::PACK_FILE_EXTENSION;
+
+  if(!writePack(out, path)){
+    std::fprintf(stderr, "failed to write '%s'\n", path.c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::printf("packed %zu prop definitions and %zu levels into %s\n",
+              out._propDefinitions.size(), out._levels.size(), path.c_str());
+  return EXIT_SUCCESS;
+}
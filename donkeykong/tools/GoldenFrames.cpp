@@ -0,0 +1,218 @@
+//
+// Golden frame regression check. The game (DonkeyKong and its PlayState, as the engine runs
+// it) is stepped headless at the engine's 50Hz tick with the CPU rasterizer enabled, its
+// input played back from a recorded replay; every Nth frame is composited and hashed. In
+// record mode the hashes are written to the golden file, in check mode they are compared
+// against it and any mismatch fails the run.
+//
+// The run is fully deterministic (fixed tick, replayed input, Random seeded from the replay),
+// so any change to the simulation or draw path which alters a single pixel of a sampled frame
+// is reported, with the tick of the first difference.
+//
+// usage: dk_golden <record|check> <replay> <ticks> <interval> [goldenFile]
+//
+// The replay is named as in the dkconfig replay element (replays/<replay>.dkr) and must hold
+// at least 'ticks' ticks, as the game quits when playback ends. goldenFile defaults to
+// golden/frames.golden. Must be run from the game root dir (as the game is).
+//
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Headless.h"
+#include "Rasterizer.h"
+#include "InputReplay.h"
+#include "DonkeyKong.h"
+
+static constexpr const char* defaultGoldenPath {"golden/frames.golden"};
+
+//
+// The engine's fixed tick (fpsLock=50); replays recorded by the game store this dt.
+//
+static constexpr float tickDuration {1.f / 50.f};
+
+struct FrameHash
+{
+  long _tick;
+  uint64_t _hash;
+};
+
+//
+// PlayState quits (through std::exit) when playback ends or mario runs out of lives, which
+// must not pass for a complete run.
+//
+static bool isRunComplete {false};
+static long lastTick {0};
+
+static void onQuit()
+{
+  if(isRunComplete)
+    return;
+  std::fprintf(stderr, "the game quit at tick %ld; the replay is too short or mario died\n", lastTick);
+  std::_Exit(EXIT_FAILURE);
+}
+
+//
+// FNV-1a over the bytes of the pixels.
+//
+static uint64_t hashPixels(const std::vector<uint32_t>& pixels)
+{
+  uint64_t hash {14695981039346656037ull};
+  for(uint32_t pixel : pixels){
+    for(int b = 0; b < 4; ++b){
+      hash ^= (pixel >> (8 * b)) & 0xff;
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+static bool runGame(const std::string& replayName, long ticks, long interval,
+                    std::vector<FrameHash>& hashes)
+{
+  headless::enableRasterizer();
+
+  DonkeyKong game {InputReplay::MODE_PLAYBACK, replayName};
+  if(!game.onInit()){
+    std::fprintf(stderr, "failed to initialize the game\n");
+    return false;
+  }
+
+  std::atexit(onQuit);
+
+  Rasterizer* rasterizer = headless::getRasterizer();
+  std::vector<uint32_t> frame {};
+  double now {0.0};
+
+  for(long tick = 0; tick < ticks; ++tick){
+    lastTick = tick;
+    game.onUpdate(now, tickDuration);
+    game.onDraw(now, tickDuration);
+    headless::endTick();
+
+    if(tick % interval == 0){
+      rasterizer->composite(frame);
+      hashes.push_back(FrameHash{tick, hashPixels(frame)});
+    }
+
+    now += tickDuration;
+  }
+
+  isRunComplete = true;
+  game.onShutdown();
+  return true;
+}
+
+static bool writeGolden(const std::string& path, const std::vector<FrameHash>& hashes)
+{
+  std::ofstream file {path};
+  if(!file){
+    std::fprintf(stderr, "failed to open '%s' for writing\n", path.c_str());
+    return false;
+  }
+  for(const auto& hash : hashes){
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%016" PRIx64, hash._hash);
+    file << hash._tick << ' ' << buffer << '\n';
+  }
+  return static_cast<bool>(file);
+}
+
+static bool readGolden(const std::string& path, std::vector<FrameHash>& hashes)
+{
+  std::ifstream file {path};
+  if(!file){
+    std::fprintf(stderr, "failed to open '%s'\n", path.c_str());
+    return false;
+  }
+  std::string line {};
+  while(std::getline(file, line)){
+    if(line.empty())
+      continue;
+    std::istringstream stream {line};
+    FrameHash hash {};
+    std::string hex {};
+    if(!(stream >> hash._tick >> hex)){
+      std::fprintf(stderr, "malformed golden line '%s'\n", line.c_str());
+      return false;
+    }
+    hash._hash = std::strtoull(hex.c_str(), nullptr, 16);
+    hashes.push_back(hash);
+  }
+  return true;
+}
+
+//
+// Returns the number of mismatched frames; a missing or extra frame counts as a mismatch.
+//
+static int compare(const std::vector<FrameHash>& golden, const std::vector<FrameHash>& actual)
+{
+  int mismatches {0};
+  size_t count = std::max(golden.size(), actual.size());
+  for(size_t i = 0; i < count; ++i){
+    if(i >= golden.size()){
+      std::printf("extra frame %ld\n", actual[i]._tick);
+      ++mismatches;
+    }
+    else if(i >= actual.size()){
+      std::printf("missing frame %ld\n", golden[i]._tick);
+      ++mismatches;
+    }
+    else if(golden[i]._tick != actual[i]._tick || golden[i]._hash != actual[i]._hash){
+      std::printf("mismatch at %ld (golden %ld %016" PRIx64 ", got %016" PRIx64 ")\n",
+                  actual[i]._tick, golden[i]._tick, golden[i]._hash, actual[i]._hash);
+      ++mismatches;
+    }
+  }
+  return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 5 || argc > 6 || (std::strcmp(argv[1], "record") != 0 && std::strcmp(argv[1], "check") != 0)){
+    std::fprintf(stderr, "usage: dk_golden <record|check> <replay> <ticks> <interval> [goldenFile]\n");
+    return EXIT_FAILURE;
+  }
+
+  bool isRecord = std::strcmp(argv[1], "record") == 0;
+  std::string replayName {argv[2]};
+  long ticks = std::strtol(argv[3], nullptr, 10);
+  long interval = std::strtol(argv[4], nullptr, 10);
+  std::string goldenPath = argc == 6 ? argv[5] : defaultGoldenPath;
+
+  if(ticks < 1 || interval < 1){
+    std::fprintf(stderr, "ticks and interval must be positive\n");
+    return EXIT_FAILURE;
+  }
+
+  //
+  // read the golden file first so a missing one fails before the (long) run.
+  //
+  std::vector<FrameHash> golden {};
+  if(!isRecord && !readGolden(goldenPath, golden)){
+    std::fprintf(stderr, "record the golden file with: dk_golden record %s %ld %ld %s\n",
+                 replayName.c_str(), ticks, interval, goldenPath.c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::vector<FrameHash> hashes {};
+  if(!runGame(replayName, ticks, interval, hashes))
+    return EXIT_FAILURE;
+
+  if(isRecord){
+    if(!writeGolden(goldenPath, hashes))
+      return EXIT_FAILURE;
+    std::printf("recorded %zu frames to %s\n", hashes.size(), goldenPath.c_str());
+    return EXIT_SUCCESS;
+  }
+
+  int mismatches = compare(golden, hashes);
+  std::printf("%zu frames checked, %d mismatched\n", hashes.size(), mismatches);
+  return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,196 @@
+//
+// Writes a synthetic level file for stress testing. Props are picked from the definitions
+// in the prop definitions file (gameprops.xml) and scattered uniformly over the world. Props
+// whose definitions change state or move are 'moving', the rest are 'static'; the ratio of
+// moving to static props is controlled independently of the mix of definitions.
+//
+// usage: dk_levelgen <name> <propCount> <movingRatio> <seed> [propName ...]
+//
+//   name        - the level is written to assets/levels/<name>.xml
+//   propCount   - number of props in the level
+//   movingRatio - fraction [0, 1] of props which use moving definitions
+//   seed        - seed of the generator; the same arguments always produce the same level
+//   propName    - the definitions to pick from; defaults to all definitions
+//
+// Must be run from the game root dir (as the game is).
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "pixiretro/pxr_xml.h"
+#include "PropFactory.h"
+#include "Level.h"
+#include "Defines.h"
+
+using namespace tinyxml2;
+
+struct PropDefinitionInfo
+{
+  std::string _name;
+  bool _isMoving;
+};
+
+//
+// Reads the names of all prop definitions and whether each is moving, using the same
+// criteria as Prop::isStatic.
+//
+static bool readPropDefinitions(std::vector<PropDefinitionInfo>& infos)
+{
+  std::string xmlpath {};
+  xmlpath += PropFactory::PROP_DEFINITIONS_FILE_PATH;
+  xmlpath += PropFactory::PROP_DEFINITIONS_FILE_NAME;
+  xmlpath += pxr::io::XML_FILE_EXTENSION;
+
+  XMLDocument doc {};
+  if(!pxr::io::parseXmlDocument(&doc, xmlpath))
+    return false;
+
+  XMLElement* xmlprop {nullptr};
+  if(!pxr::io::extractChildElement(&doc, &xmlprop, "prop"))
+    return false;
+
+  do {
+    const char* propName {nullptr};
+    if(!pxr::io::extractStringAttribute(xmlprop, "name", &propName)) return false;
+
+    int stateCount {0};
+    int maxPointCount {0};
+    for(XMLElement* xmlstate = xmlprop->FirstChildElement("state"); xmlstate != nullptr; 
+        xmlstate = xmlstate->NextSiblingElement("state"))
+    {
+      ++stateCount;
+      XMLElement* xmltransition = xmlstate->FirstChildElement("transition");
+      XMLElement* xmlpositions = xmltransition ? xmltransition->FirstChildElement("positions") : nullptr;
+      if(xmlpositions == nullptr)
+        continue;
+      int pointCount {0};
+      for(XMLElement* xmlpoint = xmlpositions->FirstChildElement("point"); xmlpoint != nullptr;
+          xmlpoint = xmlpoint->NextSiblingElement("point"))
+      {
+        ++pointCount;
+      }
+      maxPointCount = std::max(maxPointCount, pointCount);
+    }
+
+    infos.push_back(PropDefinitionInfo{propName, stateCount != 1 || maxPointCount > 1});
+
+    xmlprop = xmlprop->NextSiblingElement("prop");
+  }
+  while(xmlprop != 0);
+
+  return true;
+}
+
+static void printUsage()
+{
+  std::fprintf(stderr, "usage: dk_levelgen <name> <propCount> <movingRatio> <seed> [propName ...]\n");
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 5){
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  std::string levelName {argv[1]};
+  long propCount = std::strtol(argv[2], nullptr, 10);
+  double movingRatio = std::strtod(argv[3], nullptr);
+  unsigned long long seed = std::strtoull(argv[4], nullptr, 10);
+
+  if(propCount < 1 || movingRatio < 0.0 || movingRatio > 1.0){
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  std::vector<PropDefinitionInfo> infos {};
+  if(!readPropDefinitions(infos)){
+    std::fprintf(stderr, "failed to read prop definitions\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> staticPool {};
+  std::vector<std::string> movingPool {};
+
+  auto addToPool = [&staticPool, &movingPool](const PropDefinitionInfo& info){
+    (info._isMoving ? movingPool : staticPool).push_back(info._name);
+  };
+
+  if(argc == 5){
+    for(const auto& info : infos)
+      addToPool(info);
+  }
+  else {
+    for(int i = 5; i < argc; ++i){
+      auto search = std::find_if(infos.begin(), infos.end(), [argv, i](const PropDefinitionInfo& info){
+        return info._name == argv[i];
+      });
+      if(search == infos.end()){
+        std::fprintf(stderr, "no prop definition named '%s'\n", argv[i]);
+        return EXIT_FAILURE;
+      }
+      addToPool(*search);
+    }
+  }
+
+  long movingCount = std::lround(movingRatio * propCount);
+  long staticCount = propCount - movingCount;
+
+  if((movingCount > 0 && movingPool.empty()) || (staticCount > 0 && staticPool.empty())){
+    std::fprintf(stderr, "prop mix has no %s definitions to satisfy the moving ratio\n",
+                 movingPool.empty() ? "moving" : "static");
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937_64 rng {seed};
+
+  std::vector<const std::string*> picks {};
+  picks.reserve(propCount);
+  std::uniform_int_distribution<size_t> movingPick {0, movingPool.empty() ? 0 : movingPool.size() - 1};
+  std::uniform_int_distribution<size_t> staticPick {0, staticPool.empty() ? 0 : staticPool.size() - 1};
+  for(long i = 0; i < movingCount; ++i)
+    picks.push_back(&movingPool[movingPick(rng)]);
+  for(long i = 0; i < staticCount; ++i)
+    picks.push_back(&staticPool[staticPick(rng)]);
+  std::shuffle(picks.begin(), picks.end(), rng);
+
+  std::string xmlpath {};
+  xmlpath += Level::RESOURCE_PATH_LEVEL;
+  xmlpath += levelName;
+  xmlpath += pxr::io::XML_FILE_EXTENSION;
+
+  std::ofstream file {xmlpath};
+  if(!file){
+    std::fprintf(stderr, "failed to open '%s' for writing\n", xmlpath.c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::uniform_int_distribution<int> x {0, worldSize._x - 1};
+  std::uniform_int_distribution<int> y {0, worldSize._y - 1};
+
+  file << "<?xml version=\"1.0\"?>\n";
+  file << "<!-- generated by dk_levelgen " << propCount << " " << movingRatio << " " << seed << " -->\n";
+  file << "<level>\n";
+  file << "  <marioSpawn x=\"10.0\" y=\"60.0\"/>\n";
+  file << "  <props>\n";
+  for(const std::string* name : picks)
+    file << "    <prop name=\"" << *name << "\" x=\"" << x(rng) << "\" y=\"" << y(rng) << "\"/>\n";
+  file << "  </props>\n";
+  file << "</level>\n";
+
+  if(!file){
+    std::fprintf(stderr, "failed writing '%s'\n", xmlpath.c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::printf("wrote %s: %ld props (%ld moving, %ld static)\n", xmlpath.c_str(), propCount, 
+              movingCount, staticCount);
+
+  return EXIT_SUCCESS;
+}